@@ -0,0 +1,251 @@
+//------------------------------------------------------------------------------//
+//                                                                              //
+//  OCR-NES - An NES Emulator written for the OCR A-Level                       //
+//  Computer Science Programming Project.                                       //
+//                                                                              //
+//  Copyright (C) 2021 - 2022 Conaer Macpherson                                 //
+//                                                                              //
+//------------------------------------------------------------------------------//
+
+/**
+ * @file block_cache.h
+ * @author Conaer Macpherson (Candidate No. 6189)
+ * @brief A cache of pre-decoded straight-line runs of 6502 code.
+ * @version 0.1
+ * @date 2022-03-22
+ *
+ * @copyright Copyright (c) 2021 - 2022
+ *
+ */
+
+#pragma once
+
+// Project Headers.
+#include "common.h"
+
+// Language Headers.
+#include <vector>
+
+// Forward declare the Bus class to avoid circular inclusion.
+class Bus;
+class Mapper;
+
+class BlockCache
+{
+public:
+	BlockCache();
+
+	// The maximum number of instructions decoded into one block.
+	static constexpr u8 MAX_BLOCK_LENGTH = 16;
+	// The number of blocks held, which must be a power of 2.
+	static constexpr u32 NUM_BLOCKS = 4096;
+
+	/**
+	 * @brief One pre-decoded instruction.
+	 */
+	struct Entry
+	{
+		// The address of the opcode.
+		u16 pc = 0x0000;
+		// The operand bytes following the opcode, little-endian.
+		u16 operand = 0x0000;
+		u8 opcode = 0x00;
+		// The length of the instruction in bytes, including the opcode.
+		u8 length = 0;
+		// If non-zero, this and the following instruction are run together by
+		// the handler at this index in the CPU's fused instruction table.
+		u8 fused = 0;
+	};
+
+	/**
+	 * @brief Whether a block is an idle loop: a loop back to its own start
+	 * which only reads memory and compares, so every iteration behaves the
+	 * same until something outside the CPU changes.
+	 */
+	enum Idle : u8
+	{
+		NOT_IDLE,
+		// Only reads memory which nothing but the CPU changes, i.e. RAM.
+		IDLE,
+		// Also reads PPUSTATUS, so also waits on the PPU's status flags.
+		IDLE_POLLS_STATUS
+	};
+
+	/**
+	 * @brief A straight-line run of instructions, ending at the first
+	 * instruction which may change the flow of control.
+	 */
+	struct Block
+	{
+		// The address of the first instruction.
+		u16 pc = 0x0000;
+		// The number of decoded instructions, or 0 if the block is empty.
+		u8 count = 0;
+		// Identifies the memory the block was decoded from, e.g. a PRG ROM offset.
+		u32 tag = 0;
+		// The generation of that memory when the block was decoded.
+		u32 generation = 0;
+		Entry entries[MAX_BLOCK_LENGTH];
+		Idle idle = NOT_IDLE;
+
+		// The number of times the block has been entered, and the
+		// native code compiled from it by the JIT, if any.
+		u32 executions = 0;
+		void *compiled = nullptr;
+	};
+
+	//----------------------//
+	// Interconnect Linkage	//
+	//----------------------//
+
+	void linkInterconnect(Bus *b) { bus = b; }
+
+	//------------------//
+	// Cache Interface	//
+	//------------------//
+
+	/**
+	 * @brief Finds the block starting at an address, decoding it if needed.
+	 *
+	 * @param pc The address of the first instruction.
+	 * @return Block* The block, or nullptr if the code can't be cached,
+	 * e.g. because it lies in I/O space.
+	 */
+	Block* lookup(u16 pc);
+
+	/**
+	 * @brief Notifies the cache of a CPU write, invalidating any code it modifies.
+	 *
+	 * @param addr The address written to.
+	 * @return true Cached code or the PRG mapping may have changed.
+	 * @return false No cached code was affected.
+	 */
+	bool write(u16 addr)
+	{
+		if (addr <= 0x1FFF)
+			// System RAM, only invalidated if code was decoded from the page.
+			return writeCodePage((addr & 0x07FF) >> 8);
+		else if (addr <= 0x5FFF)
+			// Never cached.
+			return false;
+		else
+			return writeCartridge(addr);
+	}
+
+	/**
+	 * @brief Invalidates every block. The cache is flushed on the next
+	 * lookup, so this is safe to call before the cartridge has been loaded.
+	 */
+	void invalidate() { stale = true; }
+
+	/**
+	 * @brief Discards the native code attached to every block.
+	 */
+	void discardCompiled();
+
+	/**
+	 * @brief Specialises reading the PRG mapping for the cartridge's mapper.
+	 * Mapper itself may be given for any mapper, calling it through the vtable.
+	 */
+	template <class MapperT>
+	void specialise() { refreshPrgMapFor = &BlockCache::refreshPrgMap<MapperT>; }
+
+	/**
+	 * @brief Gets the bit set of pages code has been decoded from, where bits
+	 * 0 - 7 are the pages of system RAM, for compiled code to check writes against.
+	 */
+	const u64 *getCodePages() const { return &codePages; }
+
+private:
+
+	//------------------//
+	// Cache Internals	//
+	//------------------//
+
+	// Pointer to the interconnect bus.
+	Bus *bus = nullptr;
+
+	std::vector<Block> blocks;
+
+	// Set when every block must be discarded before the next lookup.
+	bool stale = true;
+
+	// The 2KB of system RAM and 8KB of cartridge RAM are tracked in 256 byte
+	// pages, each with a generation which is incremented when a page that
+	// code was decoded from is written to.
+	static constexpr u8 NUM_CODE_PAGES = 8 + 32;
+	u32 pageGeneration[NUM_CODE_PAGES] = {};
+	// A bit per page, set if code has been decoded from it.
+	u64 codePages = 0;
+
+	// The PRG ROM offset mapped to each 8KB page from 0x8000, or
+	// UNMAPPED if the mapper doesn't map PRG ROM there.
+	static constexpr u32 UNMAPPED = 0xFFFFFFFF;
+	u32 prgPage[4] = { UNMAPPED, UNMAPPED, UNMAPPED, UNMAPPED };
+	// Incremented when PRG ROM itself is written to.
+	u32 romGeneration = 0;
+	// The cartridge's PRG write count when it was last checked.
+	u32 prgWriteCount = 0;
+
+	/**
+	 * @brief Invalidates a RAM page if code has been decoded from it.
+	 *
+	 * @param page The index of the page.
+	 * @return true The page held code.
+	 * @return false The page held no code.
+	 */
+	bool writeCodePage(u8 page)
+	{
+		if ((codePages & ((u64)1 << page)) == 0)
+			return false;
+
+		codePages &= ~((u64)1 << page);
+		pageGeneration[page]++;
+		return true;
+	}
+
+	/**
+	 * @brief Handles a write to cartridge space, which may be to cartridge
+	 * RAM, a mapper register or PRG ROM.
+	 *
+	 * @param addr The address written to.
+	 * @return true Cached code or the PRG mapping may have changed.
+	 * @return false No cached code was affected.
+	 */
+	bool writeCartridge(u16 addr);
+
+	/**
+	 * @brief Reads the current PRG mapping from the mapper.
+	 *
+	 * @tparam MapperT The cartridge's mapper.
+	 * @return true The mapping changed.
+	 * @return false The mapping is unchanged.
+	 */
+	template <class MapperT>
+	bool refreshPrgMap();
+
+	// refreshPrgMap() for the cartridge's mapper.
+	bool (BlockCache::*refreshPrgMapFor)() = &BlockCache::refreshPrgMap<Mapper>;
+
+	/**
+	 * @brief Discards every block.
+	 */
+	void flush();
+
+	/**
+	 * @brief Decodes a block.
+	 *
+	 * @param block The block to decode into.
+	 * @param pc The address of the first instruction.
+	 * @param end The address no instruction may extend to or beyond.
+	 */
+	void decode(Block& block, u16 pc, u32 end);
+
+	/**
+	 * @brief Determines whether a decoded block is an idle loop.
+	 *
+	 * @param block The block.
+	 * @return Idle The kind of idle loop, if any.
+	 */
+	Idle findIdle(const Block& block);
+};
@@ -25,6 +25,8 @@
 #include "cpu.h"
 #include "ppu.h"
 #include "cartridge.h"
+#include "interrupts.h"
+#include "scheduler.h"
 
 // Language Headers.
 #include <cstdint>
@@ -41,7 +43,13 @@ public:
 
 	CPU cpu;
 	PPU ppu;
-	std::shared_ptr<Cartridge> cart;
+
+	// The inserted cartridge, which the system owns, or an empty slot.
+	Cartridge *cart = &emptySlot;
+
+	// The NMI and IRQ lines, driven by the PPU and cartridge
+	// and sampled by the CPU between instructions.
+	InterruptLines interrupts;
 
 	// 2KB of RAM.
 	u8 cpuRAM[2048];
@@ -60,14 +68,43 @@ public:
      * @param addr The address to read from.
      * @return u8 The read byte.
      */
-    u8 cpuRead(u16 addr);
+    u8 cpuRead(u16 addr)
+    {
+        // RAM and ROM are read directly, anything else by the device mapped there.
+        const Page &page = pages[addr >> 8];
+        if (page.read != nullptr)
+            return page.read[addr & 0x00FF];
+
+        return (this->*page.readHandler)(addr);
+    }
+
     /**
      * @brief Writes a byte to a memory address.
      *
      * @param addr The address to write to.
      * @param data The byte to write.
      */
-    void cpuWrite(u16 addr, u8 data);
+    void cpuWrite(u16 addr, u8 data)
+    {
+        // RAM is written directly, anything else by the device mapped there.
+        const Page &page = pages[addr >> 8];
+        if (page.write != nullptr)
+            page.write[addr & 0x00FF] = data;
+        else
+            (this->*page.writeHandler)(addr, data);
+    }
+
+    /**
+     * @brief Reads a byte without any side effects, for debugging.
+     *
+     * @param addr The address to read from.
+     * @return u8 The byte, or 0 if the address is mapped to a device's registers.
+     */
+    u8 cpuPeek(u16 addr) const
+    {
+        const Page &page = pages[addr >> 8];
+        return page.read != nullptr ? page.read[addr & 0x00FF] : 0x00;
+    }
 
 	//----------------------//
 	// System Interface		//
@@ -78,7 +115,7 @@ public:
      *
      * @param cartridge The cartridge.
      */
-    void insertCartridge(const std::shared_ptr<Cartridge>& cartridge);
+    void insertCartridge(Cartridge *cartridge);
 
     /**
      * @brief Resets the system
@@ -90,11 +127,260 @@ public:
      */
     void clockCycle();
 
-    // Used to track what should be clocked on each cycle.
-    u32 clockCounter = 0;
+    /**
+     * @brief Runs the system until the PPU completes the current frame,
+     * stopping only for scheduled events rather than checking every cycle.
+     */
+    void runFrame();
+
+    /**
+     * @brief Brings the PPU up to the cycle the CPU is on, if the CPU is running
+     * ahead of it. Called before the CPU does anything the PPU could see or affect.
+     */
+    void syncPPU()
+    {
+        if (cpuRunning)
+            runPPUUntil(cpuTimestamp() + 1);
+    }
+
+    /**
+     * @brief How runFrame() keeps the CPU and PPU in step.
+     */
+    enum class Timing
+    {
+        LOCKSTEP,	// Both are clocked on every master cycle.
+        CATCH_UP,	// The CPU runs ahead between events, and the PPU catches up when needed.
+    };
+
+    // Both produce identical results, with every dispatch method, but catch-up
+    // avoids switching between the CPU and PPU on every cycle. ocrnes-verify
+    // checks this frame by frame.
+    Timing timing = Timing::CATCH_UP;
+
+    /**
+     * @brief Which of the CPU's cores runFrame() runs it with.
+     */
+    enum class CPUCore
+    {
+        FAST,           // Makes all of an instruction's accesses on its first cycle.
+        CYCLE_STEPPED,  // Makes each access on its own cycle, for timing-sensitive games.
+    };
+
+    // The cycle-stepped core always uses catch-up timing.
+    CPUCore cpuCore = CPUCore::FAST;
+
+    /**
+     * @brief Rebuilds the page table from the cartridge's current mapping.
+     * This is needed whenever the mapping may have changed, i.e. after any
+     * write to cartridge space, or after a savestate replaces the mapper's state.
+     *
+     * @param first The first page to rebuild.
+     */
+    void mapPages(u16 first = 0x00);
+
+    //--------------//
+    // Timing		//
+    //--------------//
+
+    // The number of PPU cycles since reset, the master clock of the system.
+    // At 64 bits it never wraps, however long the emulator runs for.
+    u64 masterClock = 0;
+
+    // The master clock timestamp of the CPU's next cycle.
+    u64 cpuNextDue = 0;
+
+    // The CPU runs once every 3 PPU cycles.
+    static constexpr u64 CPU_CLOCK_DIVIDER = 3;
+
+    // Future events, timestamped on the master clock.
+    Scheduler scheduler;
+
+    /**
+     * @brief Gets the master clock timestamp of the CPU cycle on which the
+     * current instruction started, or with the cycle-stepped core, the cycle
+     * of the access it is making.
+     */
+    u64 cpuTimestamp() const
+    {
+        if (cpuRunning)
+            return cpuRunBase + CPU_CLOCK_DIVIDER * cpu.executedCycles;
+
+        return masterClock;
+    }
 
 private:
 
+    // The cartridge slot, empty until a cartridge is inserted.
+    Cartridge emptySlot;
+
+    //--------------//
+    // Page Table	//
+    //--------------//
+
+    /**
+     * @brief Handlers for accesses to a device, given the full address.
+     */
+    typedef u8 (Bus::*ReadHandler)(u16 addr);
+    typedef void (Bus::*WriteHandler)(u16 addr, u8 data);
+
+    /**
+     * @brief A 256 byte page of the CPU address space, with host pointers to
+     * the memory it is mapped to, or nullptr if accesses must go through the
+     * handlers of the device mapped there, e.g. to I/O registers or cartridge RAM.
+     */
+    struct Page
+    {
+        const u8 *read = nullptr;
+        u8 *write = nullptr;
+        ReadHandler readHandler = nullptr;
+        WriteHandler writeHandler = nullptr;
+    };
+
+    Page pages[256];
+
+    // Handlers for each address of the page shared by the I/O registers and
+    // the cartridge, indexed by the low byte of the address. Entries $00 - $1F
+    // are the I/O registers, and entries $20 - $FF forward to the cartridge,
+    // which is given $4020 - $40FF when it is inserted.
+    ReadHandler ioReadHandlers[0x100];
+    WriteHandler ioWriteHandlers[0x100];
+
+    /**
+     * @brief Maps a device to a range of whole pages of the CPU address space.
+     *
+     * @param first The first address of the range.
+     * @param last The last address of the range.
+     * @param read The handler for reads from the range.
+     * @param write The handler for writes to the range.
+     */
+    void mapDevice(u16 first, u16 last, ReadHandler read, WriteHandler write);
+
+    /**
+     * @brief Maps a device to an address in the I/O registers' page.
+     *
+     * @param addr The address, from $4000 - $40FF.
+     * @param read The handler for reads from the register.
+     * @param write The handler for writes to the register.
+     */
+    void mapRegister(u16 addr, ReadHandler read, WriteHandler write);
+
+    //--------------//
+    // Devices		//
+    //--------------//
+
+    // System RAM, mirrored every 2KB.
+    u8 readRAM(u16 addr) { return cpuRAM[addr & 0x07FF]; }
+    void writeRAM(u16 addr, u8 data) { cpuRAM[addr & 0x07FF] = data; }
+
+    // PPU registers, mirrored every 8 bytes.
+    u8 readPPU(u16 addr);
+    void writePPU(u16 addr, u8 data);
+
+    // The I/O registers, or the cartridge beyond them.
+    u8 readIO(u16 addr);
+    void writeIO(u16 addr, u8 data);
+
+    // Unmapped addresses, and the APU, which isn't implemented.
+    u8 readOpenBus(u16 addr) { return 0x00; }
+    void writeIgnored(u16 addr, u8 data) {}
+
+    // Writing to $4014 initiates a DMA transfer.
+    void writeDMA(u16 addr, u8 data);
+
+    // The controller ports.
+    u8 readController(u16 addr);
+    void writeController(u16 addr, u8 data);
+
+    // The cartridge, from $4020 upwards.
+    template <class MapperT>
+    u8 readCartridge(u16 addr);
+    template <class MapperT>
+    void writeCartridge(u16 addr, u8 data);
+
+    /**
+     * @brief Rebuilds the pages of PRG ROM from the cartridge's current mapping.
+     *
+     * @param first The first page to rebuild, at least $60.
+     */
+    template <class MapperT>
+    void mapPrgPages(u16 first);
+
+    // mapPrgPages() for the cartridge's mapper.
+    void (Bus::*mapCartridgePages)(u16 first) = nullptr;
+
+    /**
+     * @brief Specialises the cartridge's handlers, and the PPU, for its mapper,
+     * so that every access to the mapper is a direct call. Mapper itself
+     * may be given for any mapper, calling it through the vtable.
+     */
+    template <class MapperT>
+    void specialise();
+
+    //--------------//
+    // Events		//
+    //--------------//
+
+    /**
+     * @brief Runs a frame with one of the CPU's cores.
+     *
+     * @tparam Core The core, CPU::FastCore or CPU::CycleSteppedCore.
+     * @param frameTiming How the CPU and PPU are kept in step for the frame.
+     */
+    template <class Core>
+    void runFrameWith(Timing frameTiming);
+
+    /**
+     * @brief Schedules every event from the current state of the system,
+     * which may have been reset or loaded from a savestate since they were last run.
+     *
+     * @param frameTiming How the CPU and PPU are kept in step for the frame.
+     */
+    void scheduleEvents(Timing frameTiming);
+
+    /**
+     * @brief Handles every event which is due.
+     */
+    void runEvents();
+
+    //--------------//
+    // Catch-Up		//
+    //--------------//
+
+    // Whether the CPU is running ahead of the PPU.
+    bool cpuRunning = false;
+
+    // While running ahead, the CPU's cycles are on this timestamp plus
+    // CPU_CLOCK_DIVIDER for every cycle it has executed.
+    u64 cpuRunBase = 0;
+
+    // Whether the CPU stopped running ahead to start a DMA transfer,
+    // and the timestamp of the instruction which did so.
+    bool cpuStopped = false;
+    u64 cpuStopTick = 0;
+
+    /**
+     * @brief Runs the CPU ahead of the PPU, for its cycles before a timestamp.
+     *
+     * @tparam Core The core to run the CPU with.
+     * @param timestamp The master clock timestamp.
+     */
+    template <class Core>
+    void runCPUUntil(u64 timestamp);
+
+    /**
+     * @brief Runs the PPU alone, for its cycles before a timestamp.
+     *
+     * @param timestamp The master clock timestamp.
+     */
+    void runPPUUntil(u64 timestamp)
+    {
+        if (masterClock < timestamp)
+        {
+            ppu.run(timestamp - masterClock);
+            masterClock = timestamp;
+        }
+    }
+
     //------//
     // DMA  //
     //------//
@@ -109,6 +395,16 @@ private:
     // Flag indicating a DMA transfer is in progress.
 	bool dmaInProgress = false;
 
+    /**
+     * @brief Performs a whole DMA transfer at once, stalling the CPU for as many
+     * cycles as it would take, if its source can be read without side effects
+     * and the frame won't end during it.
+     *
+     * @return true If the transfer was performed.
+     * @return false If it must be clocked one byte at a time.
+     */
+    bool transferDMA();
+
 public:
 
     //--------------//
@@ -34,6 +34,68 @@
 #include <string>
 #include <vector>
 
+// Every mapper a cartridge can be loaded with, as MAPPER(id, class). The mapper
+// is created, and the bus, PPU and block cache specialised for it, from this table.
+#define OCRNES_MAPPER_TABLE(MAPPER) \
+	MAPPER(0, Mapper_000) \
+	MAPPER(1, Mapper_001) \
+	MAPPER(2, Mapper_002) \
+	MAPPER(3, Mapper_003) \
+	MAPPER(4, Mapper_004) \
+	MAPPER(66, Mapper_066)
+
+/**
+ * @brief A row of an 8x8 CHR tile, with its bit planes, and its 2-bit pixels
+ * decoded a byte each, so that they can be drawn 8 at a time.
+ */
+struct ChrRow
+{
+	// The bit planes, as stored and H-flipped.
+	u8 lo = 0x00;
+	u8 hi = 0x00;
+	u8 loFlipped = 0x00;
+	u8 hiFlipped = 0x00;
+
+	// The pixels, left to right, as stored and H-flipped.
+	u8 pixels[8] = {};
+	u8 pixelsFlipped[8] = {};
+
+	/**
+	 * @brief Decodes a row's bit planes into its pixels.
+	 *
+	 * @param lo The low bit plane.
+	 * @param hi The high bit plane.
+	 * @param pixels The 8 bytes to store the pixels in, left to right.
+	 */
+	static void decode(u8 lo, u8 hi, u8 *pixels)
+	{
+		for (u8 i = 0; i < 8; i++)
+			pixels[i] = (((hi << i) & 0x80) >> 6) | (((lo << i) & 0x80) >> 7);
+	}
+
+	/**
+	 * @brief Sets the row from its bit planes.
+	 *
+	 * @param lo The low bit plane.
+	 * @param hi The high bit plane.
+	 */
+	void set(u8 lo, u8 hi)
+	{
+		this->lo = lo;
+		this->hi = hi;
+		decode(lo, hi, pixels);
+
+		loFlipped = 0x00;
+		hiFlipped = 0x00;
+		for (u8 i = 0; i < 8; i++)
+		{
+			pixelsFlipped[i] = pixels[7 - i];
+			loFlipped |= ((lo >> i) & 0x01) << (7 - i);
+			hiFlipped |= ((hi >> i) & 0x01) << (7 - i);
+		}
+	}
+};
+
 class Cartridge
 {
 public:
@@ -65,6 +127,7 @@ public:
      * @return true Success.
      * @return false Failure.
      */
+	template <class MapperT = Mapper>
 	bool cpuRead(u16 addr, u8& data);
 	/**
      * @brief Writes a byte to a memory address.
@@ -74,6 +137,7 @@ public:
      * @return true Success.
      * @return false Failure.
      */
+	template <class MapperT = Mapper>
 	bool cpuWrite(u16 addr, u8 data);
 
     /**
@@ -84,6 +148,7 @@ public:
      * @return true Success.
      * @return false Failure.
      */
+	template <class MapperT = Mapper>
 	bool ppuRead(u16 addr, u8& data);
     /**
      * @brief Writes a byte to the PPU bus.
@@ -93,8 +158,18 @@ public:
      * @return true Success.
      * @return false Failure.
      */
+	template <class MapperT = Mapper>
 	bool ppuWrite(u16 addr, u8 data);
 
+     /**
+      * @brief Reads a row of a CHR tile from the PPU bus, already decoded.
+      *
+      * @param addr The address of the row's low bit plane, from $0000 - $1FFF.
+      * @return const ChrRow* The row, or nullptr if the mapper doesn't map the address.
+      */
+	template <class MapperT = Mapper>
+	const ChrRow* ppuReadRow(u16 addr);
+
 	/**
      * @brief Resets the cartridge and mapper to a known state.
      */
@@ -105,17 +180,27 @@ public:
 	//--------------//
 
 	/**
-     * @brief Gets the mapper.
+     * @brief Gets the mapper, which the cartridge owns.
      *
-     * @return std::shared_ptr<Mapper> The mapper.
+     * @return Mapper* The mapper, or nullptr if no ROM is loaded.
      */
-	std::shared_ptr<Mapper> getMapper();
+	Mapper *getMapper() { return mapper.get(); }
+
+	/**
+	 * @brief Gets the mapper as its concrete type, so that calls to it
+	 * are direct. Mapper itself may be given to call through the vtable.
+	 *
+	 * @return MapperT& The mapper.
+	 */
+	template <class MapperT>
+	MapperT &as() { return static_cast<MapperT&>(*mapper); }
 
     /**
      * @brief Returns the mirror configuration.
      *
      * @return Mirror The mirror configuration.
      */
+	template <class MapperT = Mapper>
 	Mirror mirror();
 
      /**
@@ -123,6 +208,24 @@ public:
       */
      u8 getMapperID();
 
+     /**
+      * @brief Returns the number of writes which have modified PRG memory,
+      * which some mappers allow, so that decoded code can be invalidated.
+      */
+     u32 getPrgWriteCount() { return prgWriteCount; }
+
+     /**
+      * @brief Gets a host pointer to the PRG ROM currently mapped at a range
+      * of the CPU address space, so that it can be read directly.
+      *
+      * @param addr The address of the start of the range.
+      * @param size The size of the range.
+      * @return u8* The PRG ROM mapped at the range, or nullptr if the range isn't
+      * mapped to a contiguous run of PRG ROM, e.g. because it is cartridge RAM.
+      */
+     template <class MapperT = Mapper>
+     u8* getPrgPointer(u16 addr, u16 size);
+
 private:
 
 	//----------------------//
@@ -138,7 +241,31 @@ private:
 	std::vector<u8> prgMemory;
 	std::vector<u8> chrMemory;
 
-	std::shared_ptr<Mapper> mapper;
+	u32 prgWriteCount = 0;
+
+	// Every row of every tile in CHR memory, decoded, at the offset of its
+	// low bit plane / 2. Being indexed by CHR memory rather than by the PPU
+	// address space, bank switches need nothing done to it, and only writes
+	// to CHR RAM change it.
+	std::vector<ChrRow> chrRows;
+
+	/**
+	 * @brief Decodes the row of a tile holding a byte of CHR memory.
+	 *
+	 * @param offset The offset of the byte.
+	 */
+	void decodeChrRow(u32 offset)
+	{
+		u32 lo = offset & ~0x08;
+		chrRows[((lo >> 4) << 3) | (lo & 0x07)].set(chrMemory[lo], chrMemory[lo + 8]);
+	}
+
+	/**
+	 * @brief Decodes every row of CHR memory.
+	 */
+	void decodeChr();
+
+	std::unique_ptr<Mapper> mapper;
 
 public:
     //--------------//
@@ -159,3 +286,129 @@ public:
       */
      void loadSaveStateData(std::ifstream& state);
 };
+
+//------------------------------//
+// Interconnect Bus Linkage     //
+//------------------------------//
+
+template <class MapperT>
+bool Cartridge::cpuRead(u16 addr, u8& data)
+{
+	u32 mappedAddr = 0;
+
+	if (as<MapperT>().cpuMapRead(addr, mappedAddr, data))
+	{
+		if (mappedAddr == 0xFFFFFFFF)
+			// Mapper has set the data value, e.g., cartridge RAM.
+			return true;
+		else
+			// Mapper has produced an offset into cartridge bank memory.
+			data = prgMemory[mappedAddr];
+
+		return true;
+	}
+	else
+		return false;
+}
+
+template <class MapperT>
+bool Cartridge::cpuWrite(u16 addr, u8 data)
+{
+	u32 mappedAddr = 0;
+
+	if (as<MapperT>().cpuMapWrite(addr, mappedAddr, data))
+	{
+		if (mappedAddr == 0xFFFFFFFF)
+			// Mapper has set the data value, e.g., cartridge RAM.
+			return true;
+		else
+		{
+			// Mapper has produced an offset into cartridge bank memory.
+			// Only count writes which modify it, as they invalidate decoded code.
+			if (prgMemory[mappedAddr] != data)
+				prgWriteCount++;
+			prgMemory[mappedAddr] = data;
+		}
+		return true;
+	}
+	else
+		return false;
+}
+
+template <class MapperT>
+bool Cartridge::ppuRead(u16 addr, u8& data)
+{
+	u32 mappedAddr = 0;
+
+	if (as<MapperT>().ppuMapRead(addr, mappedAddr))
+	{
+		data = chrMemory[mappedAddr];
+		return true;
+	}
+	else
+		return false;
+}
+
+template <class MapperT>
+bool Cartridge::ppuWrite(u16 addr, u8 data)
+{
+	u32 mappedAddr = 0;
+
+	if (as<MapperT>().ppuMapWrite(addr, mappedAddr))
+	{
+		chrMemory[mappedAddr] = data;
+		decodeChrRow(mappedAddr);
+		return true;
+	}
+	else
+		return false;
+}
+
+template <class MapperT>
+const ChrRow* Cartridge::ppuReadRow(u16 addr)
+{
+	u32 mappedAddr = 0;
+
+	// Banks are at least 1KB, so both bit planes are mapped alongside each other.
+	if (as<MapperT>().ppuMapRead(addr, mappedAddr))
+		return &chrRows[((mappedAddr >> 4) << 3) | (mappedAddr & 0x07)];
+	else
+		return nullptr;
+}
+
+//--------------//
+// Getters      //
+//--------------//
+
+template <class MapperT>
+Mirror Cartridge::mirror()
+{
+	Mirror m = as<MapperT>().mirror();
+
+	if (m == Mirror::HARDWARE)
+		// Mirror configuration is harware-defined.
+		return hwMirror;
+	else
+		// Mirror configuration can be set dynamically by the mapper.
+		return m;
+}
+
+template <class MapperT>
+u8* Cartridge::getPrgPointer(u16 addr, u16 size)
+{
+	if (mapper == nullptr)
+		return nullptr;
+
+	u32 first = 0;
+	u32 last = 0;
+	u8 data = 0x00;
+
+	// Both ends of the range must map into PRG ROM, contiguously. Banks are
+	// never smaller than the ranges asked for, so nothing between can differ.
+	if (!as<MapperT>().cpuMapRead(addr, first, data) || !as<MapperT>().cpuMapRead(addr + size - 1, last, data))
+		return nullptr;
+	if (first == 0xFFFFFFFF || last != first + size - 1 || last >= prgMemory.size())
+		return nullptr;
+
+	return &prgMemory[first];
+}
@@ -22,8 +22,13 @@
 
 // Project headers.
 #include "common.h"
+#include "block_cache.h"
+#include "jit.h"
+#include "trace.h"
 
-// Language headers.
+// Language Headers.
+#include <ostream>
+#include <string>
 #include <vector>
 
 // Forward declare the Bus class to avoid circular inclusion.
@@ -32,8 +37,6 @@ class Bus;
 class CPU
 {
 public:
-	CPU();
-
 	//--------------//
 	// Registers	//
 	//--------------//
@@ -43,7 +46,8 @@ public:
 	u8 y = 0x00;
 	u8 sp = 0x00;
 	u16 pc = 0x0000;
-	u8 status = 0x00;
+	// The status register is private, as N and Z are evaluated lazily.
+	// Use getStatus() and setStatus() to access it.
 
 	/**
 	 * @brief The 8 flags in the status register, enumerated for easy access.
@@ -60,6 +64,20 @@ public:
 		N = (1 << 7),	// Negative flag.
 	};
 
+	/**
+	 * @brief Gets the status register, with N and Z evaluated from the last result.
+	 *
+	 * @return u8 The status register.
+	 */
+	u8 getStatus() const;
+
+	/**
+	 * @brief Sets the whole status register, including N and Z.
+	 *
+	 * @param s The new status register value.
+	 */
+	void setStatus(u8 s);
+
 	//--------------//
 	// Execution	//
 	//--------------//
@@ -84,12 +102,206 @@ public:
      */
 	void clockCycle();
 
+	/**
+	 * @brief Executes whole instructions until at least the given number of
+	 * cycles have elapsed. An instruction already in progress is finished first,
+	 * and no new instruction is started once the budget has been reached.
+	 *
+	 * @param budget The number of cycles to run for.
+	 * @return u32 The number of cycles actually used, which may exceed the budget
+	 * by up to the length of the final instruction.
+	 */
+	u32 runFor(u32 budget);
+
+	/**
+	 * @brief Executes whole instructions until the cycle counter reaches a timestamp.
+	 *
+	 * @param timestamp The cycle count to run until.
+	 * @return u32 The number of cycles actually used.
+	 */
+	u32 runUntil(u64 timestamp);
+
+	/**
+	 * @brief Gets the number of cycles the instruction (or interrupt) in progress has left.
+	 */
+	u8 getCyclesLeft() const { return instrCycles; }
+
+	/**
+	 * @brief Sets the number of cycles the instruction in progress has left, e.g.
+	 * when the bus converts cycles the CPU ran ahead into ones still to idle for.
+	 *
+	 * @param cycles The number of cycles.
+	 */
+	void setCyclesLeft(u8 cycles) { instrCycles = cycles; }
+
+	/**
+	 * @brief Stops runFor() after the current instruction, e.g. because the
+	 * bus needs the CPU's following cycles for DMA.
+	 */
+	void stopRun() { runBudget = 0; exitCompiled = true; }
+
+	/**
+	 * @brief Leaves compiled code after the current instruction, so the
+	 * interrupt lines are sampled before the next one.
+	 */
+	void exitBlock() { exitCompiled = true; }
+
+	// The total number of cycles executed since the last reset.
+	u64 totalCycles = 0;
+
+	// The cycles taken by every instruction, interrupt and skipped idle loop,
+	// counted as each is executed. While the CPU runs ahead of the PPU, this
+	// gives the cycle each instruction's bus accesses are made on.
+	u64 executedCycles = 0;
+
+	/**
+	 * @brief The methods available for dispatching an opcode to its implementation.
+	 */
+	enum class Dispatch
+	{
+		TABLE,	// One indirect call to the opcode's handler in the instruction table.
+		SWITCH,	// Opcode decoded by a switch, with the handler inlined into each case.
+		CACHED,	// Instructions pre-decoded into blocks, falling back to SWITCH for uncacheable code.
+		JIT,	// As CACHED, but runFor() also compiles hot blocks to native code, if the JIT is built.
+	};
+
+	// The dispatch method used by clockCycle(). All produce identical results,
+	// but the switch avoids an indirect call per instruction, and the block
+	// cache also avoids reading and decoding each instruction from the bus.
+	Dispatch dispatch = Dispatch::CACHED;
+
+	/**
+	 * @brief Whether the JIT dispatch method runs compiled code, rather than
+	 * falling back to CACHED because the JIT isn't built or can't be used.
+	 */
+	bool jitEnabled() const { return jit.enabled(); }
+
+	//----------------------//
+	// Cycle-Stepped Core	//
+	//----------------------//
+
+	/**
+	 * @brief Executes whole instructions as runFor() does, but makes each of an
+	 * instruction's accesses to the bus on the cycle the 6502 would, including
+	 * the dummy reads and writes of indexed and read-modify-write instructions,
+	 * rather than all of them on its first cycle. While the CPU runs ahead of
+	 * the PPU, the bus sees the cycle of each access through executedCycles.
+	 *
+	 * @param budget The number of cycles to run for.
+	 * @return u32 The number of cycles actually used.
+	 */
+	u32 runCycleStepped(u32 budget);
+
+	/**
+	 * @brief The cores the bus can run the CPU with, as template policies,
+	 * so the choice is made once per frame rather than per instruction.
+	 */
+	struct FastCore
+	{
+		static u32 run(CPU& cpu, u32 budget) { return cpu.runFor(budget); }
+	};
+
+	struct CycleSteppedCore
+	{
+		static u32 run(CPU& cpu, u32 budget) { return cpu.runCycleStepped(budget); }
+	};
+
+	/**
+	 * @brief How an instruction accesses the memory at its effective address.
+	 */
+	enum class Access : u8
+	{
+		NONE,	// Only the stack, the zero page or the PC, which have no side effects.
+		READ,	// Reads its operand.
+		WRITE,	// Writes its result.
+		MODIFY,	// Reads its operand, writes it back unchanged, then writes its result.
+	};
+
 	//----------------------//
 	// Interconnect Linkage	//
 	//----------------------//
 
-	void linkInterconnect(Bus *b) { bus = b; }
+	void linkInterconnect(Bus *b) { bus = b; blockCache.linkInterconnect(b); }
+
+	/**
+	 * @brief Discards all pre-decoded code, e.g. when a cartridge is inserted.
+	 */
+	void invalidateBlockCache();
+
+	/**
+	 * @brief Specialises the block cache for the cartridge's mapper, so that
+	 * it reads the PRG mapping with direct calls.
+	 */
+	template <class MapperT>
+	void specialise() { blockCache.specialise<MapperT>(); }
+
+	//----------------------//
+	// Superinstructions	//
+	//----------------------//
+
+	/**
+	 * @brief Finds the fused handler for a pair of consecutive instructions.
+	 *
+	 * @param first The first instruction.
+	 * @param second The instruction following it.
+	 * @return u8 The index of the pair in the fused instruction table, or 0
+	 * if the pair can't be fused.
+	 */
+	static u8 findFused(const BlockCache::Entry& first, const BlockCache::Entry& second);
 
+	//------------------//
+	// Pair Profiling	//
+	//------------------//
+
+	/**
+	 * @brief The number of times one opcode was executed directly after another.
+	 */
+	struct PairCount
+	{
+		u8 first = 0x00;
+		u8 second = 0x00;
+		u64 count = 0;
+	};
+
+	/**
+	 * @brief Starts or stops counting executed pairs of instructions,
+	 * clearing the counts when started.
+	 *
+	 * @param enabled Whether to count pairs.
+	 */
+	void setPairProfiling(bool enabled);
+
+	/**
+	 * @brief Gets the most frequently executed pairs of instructions.
+	 *
+	 * @param n The maximum number of pairs to return.
+	 * @return std::vector<PairCount> The pairs, most frequent first.
+	 */
+	std::vector<PairCount> getHottestPairs(size_t n);
+
+	/**
+	 * @brief Gets the mnemonic and addressing mode of an opcode, e.g. "LDA ZP0".
+	 *
+	 * @param opcode The opcode.
+	 * @return std::string The name of the opcode.
+	 */
+	static std::string getOpcodeName(u8 opcode);
+
+	//--------------//
+	// Tracing		//
+	//--------------//
+
+	// The last instructions executed, if built with the OCRNES_CPU_TRACE option.
+	// Interrupts and the iterations of skipped idle loops aren't recorded.
+	TraceBuffer<OCRNES_CPU_TRACE_LENGTH> trace;
+
+	/**
+	 * @brief Writes the traced instructions, oldest first, one per line in the
+	 * format of the nestest log, so the two can be compared with a diff.
+	 *
+	 * @param out The stream to write to.
+	 */
+	void dumpTrace(std::ostream& out) const;
 
 private:
 
@@ -112,10 +324,29 @@ private:
      */
 	void setFlag(Flag f, bool v);
 
+	/**
+	 * @brief Sets N and Z from a result, deferring their evaluation until
+	 * the status register is observed.
+	 *
+	 * @param result The result byte. Bit 8 forces N, for BIT.
+	 */
+	void setNZ(u16 result);
+
 	//-------------------------//
     // Emulation Variables     //
     //-------------------------//
 
+	/**
+	 * @brief The addressing modes, enumerated so instructions can be specialised on them.
+	 */
+	enum class AddrMode : u8
+	{
+		IMP, IMM, ZP0,
+		ZPX, ZPY, REL,
+		ABS, ABX, ABY,
+		IND, IZX, IZY,
+	};
+
 	// Opcode of the instruction currently being executed.
 	u8 curOpcode = 0x00;
 	// Absolute address.
@@ -130,6 +361,75 @@ private:
 	// u16 thousands of times per second.
 	u16 resBuf = 0x0000;
 
+	/**
+	 * @brief Records the instruction at an address in the trace, with the
+	 * registers before it is executed. Only called if tracing is built in.
+	 *
+	 * @param addr The address of the instruction.
+	 */
+	void traceInstruction(u16 addr);
+
+	// Pre-decoded code for the CACHED and JIT dispatch methods.
+	BlockCache blockCache;
+	// The block being executed, and the index of its next instruction.
+	const BlockCache::Block *block = nullptr;
+	u8 blockIndex = 0;
+
+	// Compiles hot blocks for the JIT dispatch method.
+	JIT jit;
+	// Set to stop compiled code, or a fused pair, after the current instruction,
+	// e.g. when a write invalidates code, which may include the rest of the block.
+	bool exitCompiled = false;
+
+	// The number of cycles the current runFor() call may use.
+	u32 runBudget = 0;
+
+	// The number of instructions executed, and the cycles they took,
+	// used to recognise uninterrupted iterations of idle loops.
+	u32 stepCount = 0;
+	u32 stepCycles = 0;
+
+	/**
+	 * @brief The state at the start of the last iteration of an idle loop.
+	 */
+	struct IdleSnapshot
+	{
+		bool valid = false;
+		u16 pc = 0x0000;
+		u8 a = 0x00;
+		u8 x = 0x00;
+		u8 y = 0x00;
+		u8 sp = 0x00;
+		u8 status = 0x00;
+		u16 nz = 0x0000;
+		u32 steps = 0;
+		u32 cycles = 0;
+	} idleSnapshot;
+
+	// Whether pairs are being profiled, the count for each pair indexed by
+	// the first opcode in the high byte, and the last opcode executed.
+	bool pairProfiling = false;
+	std::vector<u64> pairCounts;
+	u8 lastOpcode = 0x00;
+
+	/**
+	 * @brief Counts an executed opcode against the one before it.
+	 *
+	 * @param opcode The opcode executed.
+	 */
+	void profilePair(u8 opcode)
+	{
+		pairCounts[((u16)lastOpcode << 8) | opcode]++;
+		lastOpcode = opcode;
+	}
+
+	// The status register, except for N and Z, which are not kept up to date here.
+	u8 status = 0x00;
+
+	// The last result affecting N and Z. Z is set if the low byte is zero,
+	// and N is set if bit 7 or 8 is.
+	u16 nz = 0x0001;
+
 	//--------------------------------//
 	// Interconnect Linkage	(Private) //
 	//--------------------------------//
@@ -153,13 +453,88 @@ private:
      */
 	void write(u16 a, u8 d);
 
+	/**
+	 * @brief Reads a byte from the zero page or stack directly from system RAM,
+	 * bypassing the bus. No mapper may claim these pages, which the bus asserts
+	 * whenever it maps devices or rebuilds its page table.
+	 *
+	 * @param a The address to read from, which must be in the first 2KB.
+	 * @return u8 The read byte.
+	 */
+	u8 readRAM(u16 a);
+
+	/**
+	 * @brief Writes a byte to the zero page or stack directly in system RAM,
+	 * bypassing the bus.
+	 *
+	 * @param a The address to write to, which must be in the first 2KB.
+	 * @param d The data to write.
+	 */
+	void writeRAM(u16 a, u8 d);
+
     /**
      * @brief Fetches the data an instruction needs based on its addressing mode.
      *
+     * @tparam M The addressing mode of the current instruction.
      * @return u8 The fetched data.
      */
+	template <AddrMode M>
 	u8 fetch();
 
+	/**
+	 * @brief Stores the result of an instruction at the address given by its addressing mode.
+	 *
+	 * @tparam M The addressing mode of the current instruction.
+	 * @param data The data to store.
+	 */
+	template <AddrMode M>
+	void store(u8 data);
+
+	/**
+	 * @brief Executes the current opcode through the switch dispatcher.
+	 *
+	 * @return u8 The number of extra cycles needed, if any.
+	 */
+	u8 executeSwitch();
+
+	/**
+	 * @brief Reads and executes the instruction at the PC, or a fused pair of
+	 * instructions, or skips iterations of an idle loop starting at the PC.
+	 *
+	 * @param limit The number of cycles left to run. Idle loops are skipped by
+	 * at most this, and the second of a fused pair is only run within it.
+	 * @return u8 The number of cycles the instructions take, or were skipped.
+	 */
+	u8 step(u8 limit = 0xFF);
+
+	/**
+	 * @brief Services a pending NMI, or an IRQ if the line is held and they
+	 * are enabled. Called between instructions, where the 6502 samples its lines.
+	 *
+	 * @return true If an interrupt was serviced, setting instrCycles.
+	 * @return false If no interrupt was serviced.
+	 */
+	bool serviceInterrupt();
+
+	/**
+	 * @brief Skips whole iterations of an idle loop, up to the next event
+	 * which could change the value it polls or interrupt the CPU.
+	 *
+	 * @param b The block containing the loop.
+	 * @param limit The maximum number of cycles to skip.
+	 * @return u8 The number of cycles skipped, or 0 if none were.
+	 */
+	u8 skipIdle(const BlockCache::Block& b, u8 limit);
+
+	/**
+	 * @brief Executes whole blocks until the run's budget has been reached,
+	 * running the native code for those which have been compiled.
+	 *
+	 * @param used The number of cycles already used.
+	 * @return u32 The number of cycles used, including those already used.
+	 */
+	u32 runCompiled(u32 used);
+
 	//----------------------//
     // Addressing Modes     //
     //----------------------//
@@ -173,10 +548,45 @@ private:
     // changes the length of the instruction.                                   //
     //--------------------------------------------------------------------------//
 
-	u8 IMP(); u8 IMM(); u8 ZP0();
-	u8 ZPX(); u8 ZPY(); u8 REL();
-	u8 ABS(); u8 ABX(); u8 ABY();
-	u8 IND(); u8 IZX(); u8 IZY();
+	// Each takes the operand of the instruction, which the PC has already been advanced past.
+	u8 IMP(u16 operand); u8 IMM(u16 operand); u8 ZP0(u16 operand);
+	u8 ZPX(u16 operand); u8 ZPY(u16 operand); u8 REL(u16 operand);
+	u8 ABS(u16 operand); u8 ABX(u16 operand); u8 ABY(u16 operand);
+	u8 IND(u16 operand); u8 IZX(u16 operand); u8 IZY(u16 operand);
+
+	/**
+	 * @brief Reads the operand of the current instruction and advances the PC past it.
+	 *
+	 * @tparam M The addressing mode.
+	 * @return u16 The operand, or 0 if it has none.
+	 */
+	template <AddrMode M>
+	u16 readOperand();
+
+	/**
+	 * @brief Runs the addressing mode function for a compile-time addressing mode.
+	 *
+	 * @tparam M The addressing mode.
+	 * @param operand The operand of the instruction.
+	 * @return u8 1 if a page boundary was crossed, otherwise 0.
+	 */
+	template <AddrMode M>
+	u8 address(u16 operand);
+
+	/**
+	 * @brief Gets the length of an instruction in an addressing mode.
+	 *
+	 * @param mode The addressing mode.
+	 * @return u8 The number of bytes, including the opcode.
+	 */
+	static constexpr u8 lengthOf(AddrMode mode)
+	{
+		if (mode == AddrMode::IMP)
+			return 1;
+		if (mode == AddrMode::ABS || mode == AddrMode::ABX || mode == AddrMode::ABY || mode == AddrMode::IND)
+			return 3;
+		return 2;
+	}
 
     //------------------//
     // Instructions     //
@@ -187,33 +597,179 @@ private:
      */
     struct Instruction
     {
-        // The instruction's implementation function.
-        u8 (CPU::*impl)(void) = nullptr;
-        // The instruction's addressing mode.
-        u8 (CPU::*addrmode)(void) = nullptr;
+        // The instruction's implementation, specialised for its addressing mode.
+        u8 (CPU::*execute)(void) = nullptr;
+        // As above, but taking an operand which has already been read.
+        u8 (CPU::*executeDecoded)(u16) = nullptr;
         // The base number of cycles the instruction takes.
         u8 cycles = 0;
     };
 
-	std::vector<Instruction> instructions;
-
-	u8 ADC(); u8 AND(); u8 ASL(); u8 BCC();
-	u8 BCS(); u8 BEQ(); u8 BIT(); u8 BMI();
-	u8 BNE(); u8 BPL(); u8 BRK(); u8 BVC();
-	u8 BVS(); u8 CLC(); u8 CLD(); u8 CLI();
-	u8 CLV(); u8 CMP(); u8 CPX(); u8 CPY();
-	u8 DEC(); u8 DEX(); u8 DEY(); u8 EOR();
-	u8 INC(); u8 INX(); u8 INY(); u8 JMP();
-	u8 JSR(); u8 LDA(); u8 LDX(); u8 LDY();
-	u8 LSR(); u8 NOP(); u8 ORA(); u8 PHA();
-	u8 PHP(); u8 PLA(); u8 PLP(); u8 ROL();
-	u8 ROR(); u8 RTI(); u8 RTS(); u8 SBC();
-	u8 SEC(); u8 SED(); u8 SEI(); u8 STA();
-	u8 STX(); u8 STY(); u8 TAX(); u8 TAY();
-	u8 TSX(); u8 TXA(); u8 TXS(); u8 TYA();
+	// Generated at compile time from opcodes.h.
+	static const Instruction instructions[256];
+
+	/**
+	 * @brief Runs an addressing mode followed by an instruction.
+	 *
+	 * @tparam M The addressing mode.
+	 * @tparam Impl The instruction, specialised for M.
+	 * @tparam PageCross Whether the instruction takes an extra cycle on a page cross.
+	 * @return u8 The number of extra cycles needed, if any.
+	 */
+	template <AddrMode M, void (CPU::*Impl)(), bool PageCross>
+	u8 execute();
+
+	/**
+	 * @brief Runs an addressing mode followed by an instruction, with an
+	 * operand which has already been read, e.g. from the block cache.
+	 *
+	 * @tparam M The addressing mode.
+	 * @tparam Impl The instruction, specialised for M.
+	 * @tparam PageCross Whether the instruction takes an extra cycle on a page cross.
+	 * @param operand The operand of the instruction.
+	 * @return u8 The number of extra cycles needed, if any.
+	 */
+	template <AddrMode M, void (CPU::*Impl)(), bool PageCross>
+	u8 executeDecoded(u16 operand);
+
+	// The handler for each opcode called by compiled code, generated from opcodes.h.
+	static const JIT::InstructionThunk compiledInstructions[256];
+
+	/**
+	 * @brief Executes one whole instruction from compiled code.
+	 *
+	 * @tparam M The addressing mode.
+	 * @tparam Impl The instruction, specialised for M.
+	 * @tparam PageCross Whether the instruction takes an extra cycle on a page cross.
+	 * @tparam Opcode The opcode of the instruction.
+	 * @tparam Cycles The base number of cycles the instruction takes.
+	 * @param cpu The CPU.
+	 * @param operand The operand of the instruction.
+	 * @param next The address of the following instruction.
+	 * @return u32 The number of cycles the instruction took.
+	 */
+	template <AddrMode M, void (CPU::*Impl)(), bool PageCross, u8 Opcode, u8 Cycles>
+	static u32 executeCompiled(CPU *cpu, u16 operand, u16 next);
+
+	// Bus accesses made by compiled code.
+	static u8 compiledRead(CPU *cpu, u16 addr) { return cpu->read(addr); }
+	static void compiledWrite(CPU *cpu, u16 addr, u8 data) { cpu->write(addr, data); }
+
+	/**
+	 * @brief Gets where compiled code finds the CPU's state and handlers.
+	 */
+	JIT::Context compiledContext() const;
+
+	/**
+	 * @brief A frequent pair of consecutive instructions, run by one handler.
+	 */
+	struct FusedInstruction
+	{
+		u8 first = 0x00;
+		u8 second = 0x00;
+		// Runs both instructions from their block cache entries, given the
+		// number of cycles left to run, returning the cycles taken.
+		u8 (CPU::*execute)(const BlockCache::Entry*, u8) = nullptr;
+	};
+
+	// Entry 0 is unused, so that an index of 0 means an instruction isn't fused.
+	static const FusedInstruction fusedInstructions[];
+
+	/**
+	 * @brief Executes a fused pair of instructions. The second is only run
+	 * if it would have started within the limit, and the first didn't set the
+	 * exit flag, otherwise it is left to be stepped to as normal.
+	 *
+	 * @tparam First The opcode of the first instruction.
+	 * @tparam Second The opcode of the second instruction.
+	 * @param entries The block cache entries of the pair.
+	 * @param limit The number of cycles left to run.
+	 * @return u8 The number of cycles taken.
+	 */
+	template <u8 First, u8 Second>
+	u8 executeFused(const BlockCache::Entry *entries, u8 limit);
+
+	// The handler for each opcode in the cycle-stepped core, generated from opcodes.h.
+	static u8 (CPU::*const cycleSteppedInstructions[256])();
+
+	// The value of executedCycles when the current instruction started.
+	u64 instrStart = 0;
+
+	/**
+	 * @brief Moves the cycle counter to a cycle of the current instruction,
+	 * before an access the bus may need to see on that cycle.
+	 *
+	 * @param cycle The cycle, counting the opcode fetch as 0.
+	 */
+	void atCycle(u8 cycle) { executedCycles = instrStart + cycle; }
+
+	/**
+	 * @brief Reads and executes the instruction at the PC with the
+	 * cycle-stepped core, or services an interrupt.
+	 *
+	 * @return u8 The number of cycles taken.
+	 */
+	u8 stepCycleStepped();
+
+	/**
+	 * @brief Executes one whole instruction with the cycle-stepped core. Its
+	 * address is worked out by its addressing mode as normal, and its accesses
+	 * to that address are then each made on their own cycle.
+	 *
+	 * @tparam M The addressing mode.
+	 * @tparam Impl The instruction, specialised for M.
+	 * @tparam A How the instruction accesses memory.
+	 * @tparam PageCross Whether the instruction takes an extra cycle on a page cross.
+	 * @tparam Opcode The opcode of the instruction.
+	 * @tparam Cycles The base number of cycles the instruction takes.
+	 * @return u8 The number of cycles the instruction took.
+	 */
+	template <AddrMode M, void (CPU::*Impl)(), Access A, bool PageCross, u8 Opcode, u8 Cycles>
+	u8 executeCycleStepped();
+
+	/**
+	 * @brief Performs the operation of a read-modify-write instruction on a value.
+	 *
+	 * @tparam Opcode The opcode of the instruction.
+	 * @param data The value read.
+	 * @return u8 The value to write back.
+	 */
+	template <u8 Opcode>
+	u8 modify(u8 data);
+
+	// Every instruction is specialised on its addressing mode, so choices such
+	// as accumulator or memory operands are made at compile time.
+	template <AddrMode M> void ADC(); template <AddrMode M> void AND();
+	template <AddrMode M> void ASL(); template <AddrMode M> void BCC();
+	template <AddrMode M> void BCS(); template <AddrMode M> void BEQ();
+	template <AddrMode M> void BIT(); template <AddrMode M> void BMI();
+	template <AddrMode M> void BNE(); template <AddrMode M> void BPL();
+	template <AddrMode M> void BRK(); template <AddrMode M> void BVC();
+	template <AddrMode M> void BVS(); template <AddrMode M> void CLC();
+	template <AddrMode M> void CLD(); template <AddrMode M> void CLI();
+	template <AddrMode M> void CLV(); template <AddrMode M> void CMP();
+	template <AddrMode M> void CPX(); template <AddrMode M> void CPY();
+	template <AddrMode M> void DEC(); template <AddrMode M> void DEX();
+	template <AddrMode M> void DEY(); template <AddrMode M> void EOR();
+	template <AddrMode M> void INC(); template <AddrMode M> void INX();
+	template <AddrMode M> void INY(); template <AddrMode M> void JMP();
+	template <AddrMode M> void JSR(); template <AddrMode M> void LDA();
+	template <AddrMode M> void LDX(); template <AddrMode M> void LDY();
+	template <AddrMode M> void LSR(); template <AddrMode M> void NOP();
+	template <AddrMode M> void ORA(); template <AddrMode M> void PHA();
+	template <AddrMode M> void PHP(); template <AddrMode M> void PLA();
+	template <AddrMode M> void PLP(); template <AddrMode M> void ROL();
+	template <AddrMode M> void ROR(); template <AddrMode M> void RTI();
+	template <AddrMode M> void RTS(); template <AddrMode M> void SBC();
+	template <AddrMode M> void SEC(); template <AddrMode M> void SED();
+	template <AddrMode M> void SEI(); template <AddrMode M> void STA();
+	template <AddrMode M> void STX(); template <AddrMode M> void STY();
+	template <AddrMode M> void TAX(); template <AddrMode M> void TAY();
+	template <AddrMode M> void TSX(); template <AddrMode M> void TXA();
+	template <AddrMode M> void TXS(); template <AddrMode M> void TYA();
 
 	// Function to capture the undefined opcodes in the NES' 6502 ISA.
-	u8 XXX();
+	template <AddrMode M> void XXX();
 
 	//----------------------//
 	// Instruction Helpers	//
@@ -222,7 +778,7 @@ private:
 	/**
      * @brief All conditional branches are the same except for the flag used, so saves code.
      */
-	u8 conditionalBranch(bool condition);
+	void conditionalBranch(bool condition);
 
 public:
 
@@ -10,7 +10,7 @@
 /**
  * @file drawable.h
  * @author Conaer Macpherson (Candidate No. 6189)
- * @brief Virtual base class for rendering targets. All renderers must extend this class and implement setPixel().
+ * @brief Virtual base class for rendering targets. All renderers must extend this class and implement submitFrame() or setPixel().
  * @version 0.1
  * @date 2022-03-22
  *
@@ -41,12 +41,46 @@ union RGBAColor
 class Drawable
 {
 public:
+    virtual ~Drawable() {}
+
+    // The size of the frames submitted.
+    static constexpr int WIDTH = 256;
+    static constexpr int HEIGHT = 240;
+
+    /**
+     * @brief Takes a finished frame. By default, passes each changed scanline
+     * to submitScanline().
+     *
+     * @param frame The frame's pixels, HEIGHT rows of WIDTH.
+     * @param dirtyRows Whether each row has changed since the last frame
+     * submitted, or nullptr if every row may have.
+     */
+    virtual void submitFrame(const RGBAColor *frame, const bool *dirtyRows)
+    {
+        for (int y = 0; y < HEIGHT; y++)
+            if (dirtyRows == nullptr || dirtyRows[y])
+                submitScanline(y, &frame[y * WIDTH]);
+    }
+
+    /**
+     * @brief Takes a finished scanline. By default, sets each pixel with setPixel().
+     *
+     * @param y The scanline.
+     * @param pixels The scanline's WIDTH pixels.
+     */
+    virtual void submitScanline(int y, const RGBAColor *pixels)
+    {
+        for (int x = 0; x < WIDTH; x++)
+            setPixel(x, y, pixels[x]);
+    }
+
     /**
-     * @brief Sets and RGBA pixel in the render target.
+     * @brief Sets and RGBA pixel in the render target. Only called by the
+     * default submitScanline(), for renderers which take a pixel at a time.
      *
      * @param x Pixel X.
      * @param y Pixel Y.
      * @param color RGBA colour to set to.
      */
-    virtual void setPixel(int x, int y, RGBAColor color) = 0;
+    virtual void setPixel(int x, int y, RGBAColor color) {}
 };
\ No newline at end of file
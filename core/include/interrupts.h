@@ -0,0 +1,121 @@
+//------------------------------------------------------------------------------//
+//                                                                              //
+//  OCR-NES - An NES Emulator written for the OCR A-Level                       //
+//  Computer Science Programming Project.                                       //
+//                                                                              //
+//  Copyright (C) 2021 - 2022 Conaer Macpherson                                 //
+//                                                                              //
+//------------------------------------------------------------------------------//
+
+/**
+ * @file interrupts.h
+ * @author Conaer Macpherson (Candidate No. 6189)
+ * @brief The CPU's NMI and IRQ input lines, driven by the PPU and cartridge.
+ * @version 0.1
+ * @date 2022-03-22
+ *
+ * @copyright Copyright (c) 2021 - 2022
+ *
+ */
+
+#pragma once
+
+// Project Headers.
+#include "common.h"
+
+//------------------------------------------------------------------------------//
+// Devices drive the lines when their interrupt outputs change, and the CPU     //
+// samples them between instructions, as the real 6502 does. NMI is edge        //
+// triggered, so a rising edge is latched until the CPU services it. IRQ is     //
+// level triggered, so it is serviced for as long as any source holds it and    //
+// the Interrupt Disable flag is clear.                                         //
+//------------------------------------------------------------------------------//
+
+class InterruptLines
+{
+public:
+	/**
+	 * @brief The devices which can hold the IRQ line, one bit each.
+	 */
+	enum IRQSource : u8
+	{
+		IRQ_MAPPER = (1 << 0),
+	};
+
+	/**
+	 * @brief Drives the NMI line, latching an NMI on a rising edge.
+	 *
+	 * @param level The level of the line.
+	 */
+	void setNMI(bool level)
+	{
+		if (level && !nmi)
+			nmiPending = true;
+		nmi = level;
+	}
+
+	/**
+	 * @brief Holds or releases the IRQ line for a source.
+	 *
+	 * @param source The device driving the line.
+	 * @param level Whether the device is requesting an interrupt.
+	 */
+	void setIRQ(IRQSource source, bool level)
+	{
+		if (level)
+			irq |= source;
+		else
+			irq &= ~source;
+	}
+
+	/**
+	 * @brief Whether an interrupt may need servicing, checked before each instruction.
+	 */
+	bool active() const { return nmiPending || irq != 0; }
+
+	/**
+	 * @brief Releases every line, e.g. on reset.
+	 */
+	void reset()
+	{
+		nmi = false;
+		nmiPending = false;
+		irq = 0;
+	}
+
+	// The level of the NMI line, and whether a rising edge is yet to be serviced.
+	bool nmi = false;
+	bool nmiPending = false;
+	// The sources holding the IRQ line.
+	u8 irq = 0;
+
+	//--------------//
+	//	SaveState	//
+	//--------------//
+
+	/**
+	 * @brief Writes save state data for the interrupt lines to an std::ofstream.
+	 *
+	 * @param state The save state std::ofstream.
+	 */
+	void writeSaveStateData(std::ofstream& state)
+	{
+		// 3 bytes.
+		state.write((char*)&nmi, sizeof(bool));
+		state.write((char*)&nmiPending, sizeof(bool));
+		state.write((char*)&irq, sizeof(u8));
+	}
+
+	/**
+	 * @brief Loads save state data for the interrupt lines from an std::ifstream.
+	 *
+	 * @param state The save state std::ifstream.
+	 */
+	void loadSaveStateData(std::ifstream& state)
+	{
+		// 3 bytes.
+		state.read((char*)&nmi, sizeof(bool));
+		state.read((char*)&nmiPending, sizeof(bool));
+		state.read((char*)&irq, sizeof(u8));
+	}
+};
@@ -0,0 +1,249 @@
+//------------------------------------------------------------------------------//
+//                                                                              //
+//  OCR-NES - An NES Emulator written for the OCR A-Level                       //
+//  Computer Science Programming Project.                                       //
+//                                                                              //
+//  Copyright (C) 2021 - 2022 Conaer Macpherson                                 //
+//                                                                              //
+//------------------------------------------------------------------------------//
+
+/**
+ * @file jit.h
+ * @author Conaer Macpherson (Candidate No. 6189)
+ * @brief Compiles blocks of 6502 code to x86-64 machine code.
+ * @version 0.1
+ * @date 2022-03-22
+ *
+ * @copyright Copyright (c) 2021 - 2022
+ *
+ */
+
+#pragma once
+
+// Project Headers.
+#include "common.h"
+#include "block_cache.h"
+
+// Language Headers.
+#include <cstddef>
+
+// Forward declare the CPU class to avoid circular inclusion.
+class CPU;
+
+//------------------------------------------------------------------------------//
+// The common loads, stores, arithmetic, compares, register operations and      //
+// branches are translated to native code, which works on the CPU's registers   //
+// in place. System RAM, including the zero page, is accessed directly, and    //
+// writes to it only leave native code if code was decoded from the page        //
+// written. Any other access goes through a call to the bus, so I/O accesses    //
+// ($2000 - $401F) and mapper registers behave exactly as in the interpreter.   //
+// Every other instruction is a direct call to its handler, with the operand    //
+// and the address of the following instruction as immediates.                  //
+//                                                                              //
+// Cycles are counted in a register. The CPU's counters are brought up to date  //
+// before any call, so the bus sees the cycle each access is made on, and when  //
+// the block exits, which happens early if the cycle budget runs out or a call  //
+// asks the CPU to stop, e.g. because a write invalidated code.                 //
+//                                                                              //
+// The JIT is only built when the OCRNES_CPU_JIT CMake option is enabled on an  //
+// x86-64 host. Otherwise, compile() always fails and the CPU interprets.       //
+//------------------------------------------------------------------------------//
+
+class JIT
+{
+public:
+	JIT();
+	~JIT();
+
+	JIT(const JIT&) = delete;
+	JIT& operator=(const JIT&) = delete;
+
+	/**
+	 * @brief A handler for a single instruction, called from compiled code.
+	 *
+	 * @param cpu The CPU.
+	 * @param operand The instruction's operand.
+	 * @param next The address of the following instruction.
+	 * @return u32 The number of cycles the instruction took.
+	 */
+	typedef u32 (*InstructionThunk)(CPU *cpu, u16 operand, u16 next);
+
+	/**
+	 * @brief A compiled block.
+	 *
+	 * @param cpu The CPU.
+	 * @param budget The number of cycles after which no new instruction is started.
+	 * @return u32 The number of cycles used.
+	 */
+	typedef u32 (*CompiledBlock)(CPU *cpu, u32 budget);
+
+	/**
+	 * @brief Where compiled code finds the CPU's state, and what it calls
+	 * for anything it doesn't do itself.
+	 */
+	struct Context
+	{
+		// The offsets of the CPU's registers from its address.
+		s32 a = 0, x = 0, y = 0, sp = 0, pc = 0, status = 0, nz = 0;
+		// The offsets of the flag set to stop after the current instruction,
+		// and of the counters of executed instructions and cycles.
+		s32 exit = 0, stepCount = 0, stepCycles = 0, executedCycles = 0;
+
+		// System RAM, and the bit set of its pages which code was decoded from.
+		u8 *ram = nullptr;
+		const u64 *codePages = nullptr;
+
+		// Accesses to anything other than system RAM.
+		u8 (*read)(CPU *cpu, u16 addr) = nullptr;
+		void (*write)(CPU *cpu, u16 addr, u8 data) = nullptr;
+
+		// The handler for each opcode, for instructions which aren't translated.
+		const InstructionThunk *thunks = nullptr;
+		// Set to call the handler for every instruction, e.g. while tracing.
+		bool handlersOnly = false;
+	};
+
+	// The number of times a block must be executed before it is compiled.
+	static constexpr u32 COMPILE_THRESHOLD = 8;
+
+	/**
+	 * @brief Whether the JIT was built, its code buffer could be allocated, and
+	 * compiled code can still be run from it.
+	 */
+	bool enabled() const { return code != nullptr && !failed; }
+
+	/**
+	 * @brief Compiles a block.
+	 *
+	 * @param block The block to compile.
+	 * @param context The CPU's state and handlers.
+	 * @return CompiledBlock The compiled block, or nullptr if the JIT is
+	 * disabled or the code buffer is full.
+	 */
+	CompiledBlock compile(const BlockCache::Block& block, const Context& context);
+
+	/**
+	 * @brief Discards all compiled code. Every pointer returned by compile() is
+	 * invalidated, so they must have been discarded by the caller.
+	 */
+	void reset() { used = 0; }
+
+private:
+
+	// Memory for compiled code, which is only ever writable or executable, never
+	// both. Only the pages a block is compiled into are made writable, while it is compiled.
+	u8 *code = nullptr;
+	size_t size = 0;
+	size_t used = 0;
+
+	// Set if the code buffer couldn't be made executable again after compiling,
+	// so nothing already compiled can be run.
+	bool failed = false;
+
+	/**
+	 * @brief Makes the pages of the code buffer covering a range writable, or executable.
+	 *
+	 * @param from The offset of the start of the range.
+	 * @param to The offset of the end of the range, which is clamped to the buffer.
+	 * @param writable Whether to make it writable rather than executable.
+	 * @return true If the protection was changed.
+	 */
+	bool protect(size_t from, size_t to, bool writable);
+
+	//------------------//
+	// Translation		//
+	//------------------//
+
+	/**
+	 * @brief Whether an instruction is translated to native code, rather
+	 * than compiled to a call to its handler.
+	 *
+	 * @param entry The instruction.
+	 */
+	static bool translatable(const BlockCache::Entry& entry);
+
+	/**
+	 * @brief Emits the native code for an instruction, leaving the number of
+	 * cycles it takes added to the cycle count.
+	 *
+	 * @param entry The instruction, which must be translatable.
+	 * @param context The CPU's state and handlers.
+	 * @param pending The number of instructions run since the CPU's counters
+	 * were last brought up to date, which is reset if they are.
+	 * @return true If the code may call out, and so must check the exit flag after.
+	 */
+	bool emitInstruction(const BlockCache::Entry& entry, const Context& context, u32& pending);
+
+	/**
+	 * @brief Emits the code to read an instruction's operand into eax, adding
+	 * the page crossing cycle to the cycle count if it takes one.
+	 *
+	 * @return true If the code calls out to the bus.
+	 */
+	bool emitRead(const BlockCache::Entry& entry, const Context& context, u32& pending);
+
+	/**
+	 * @brief Emits the code to write al to an instruction's effective address.
+	 *
+	 * @return true If the code may call out to the bus.
+	 */
+	bool emitWrite(const BlockCache::Entry& entry, const Context& context, u32& pending);
+
+	/**
+	 * @brief Emits the code to check whether a write to system RAM, at the
+	 * address in esi, was to a page code was decoded from, and if so to make
+	 * it again through the bus to invalidate the code. The byte is in al.
+	 *
+	 * @param page The page written to, or -1 to find it from esi.
+	 */
+	void emitCodeCheck(const Context& context, s32 page);
+
+	/**
+	 * @brief Emits the code to bring the CPU's counters of executed instructions
+	 * and cycles up to date, preserving every register but edi.
+	 *
+	 * @param pending The number of instructions run since they were last brought up to date.
+	 */
+	void emitSync(const Context& context, u32 pending);
+
+	/**
+	 * @brief Emits a call to a function, with the CPU as its first argument.
+	 *
+	 * @param function The address of the function.
+	 */
+	void emitCall(const void *function);
+
+	//------------------//
+	// Encoding			//
+	//------------------//
+
+	// Writes little-endian values at the end of the used code.
+	void emit8(u8 v);
+	void emit16(u16 v);
+	void emit32(u32 v);
+	void emit64(u64 v);
+
+	/**
+	 * @brief Writes a ModRM byte and displacement for a CPU member, [rbx + offset].
+	 *
+	 * @param reg The register or opcode extension in the reg field.
+	 * @param offset The offset of the member.
+	 */
+	void emitMember(u8 reg, s32 offset);
+
+	/**
+	 * @brief Writes a ModRM byte and displacement for a byte of system RAM,
+	 * [r14 + addr]. The instruction must have a REX prefix with B set.
+	 *
+	 * @param reg The register or opcode extension in the reg field.
+	 * @param addr The address, which is mirrored into the first 2KB.
+	 */
+	void emitRAM(u8 reg, u16 addr);
+
+	/**
+	 * @brief Points a rel32 field at the end of the used code.
+	 *
+	 * @param field The offset of the field.
+	 */
+	void patch(size_t field);
+};
@@ -22,6 +22,7 @@
 
 // Project Headers.
 #include "common.h"
+#include "interrupts.h"
 
 enum Mirror
 {
@@ -32,11 +33,17 @@ enum Mirror
 	ONESCREEN_HI,
 };
 
+//------------------------------------------------------------------------------//
+// Every mapper is final, and defines its PPU mapping in its header, so that    //
+// code specialised for it (see Cartridge::as()) calls it directly, inlined     //
+// into the PPU's rendering, rather than through the vtable.                    //
+//------------------------------------------------------------------------------//
+
 class Mapper
 {
 public:
 	Mapper(u8 prgBanks, u8 chrBanks);
-	~Mapper();
+	virtual ~Mapper();
 
 	//-----------------//
 	// R/W Mapping     //
@@ -96,25 +103,25 @@ public:
 	 *
 	 * @return Mirror The mirror mode.
 	 */
-	virtual Mirror mirror();
+	virtual Mirror mirror() { return Mirror::HARDWARE; }
 
 	/**
-	 * @brief Gets the IRQ state of the mapper.
+	 * @brief Connects the CPU's interrupt lines, so the mapper can drive IRQ.
 	 *
-	 * @return true IRQ.
-	 * @return false No IRQ.
+	 * @param lines The interrupt lines.
 	 */
-	virtual bool irqState();
+	void connectInterrupts(InterruptLines *lines);
 
 	/**
-	 * @brief Resets the IRQ state of the mapper.
+	 * @brief Perform a per-scanline operation.
 	 */
-	virtual void irqClear();
+	virtual void scanline();
 
 	/**
-	 * @brief Perform a per-scanline operation.
+	 * @brief Whether scanline() can raise an IRQ, in which case the CPU
+	 * can't run ahead of the PPU past the end of a scanline.
 	 */
-	virtual void scanline();
+	virtual bool scanlineIRQ();
 
 	//--------------//
 	// Save State	//
@@ -138,4 +145,18 @@ protected:
 	// Mappers commonly require this information.
 	u8 prgBanks = 0;
 	u8 chrBanks = 0;
+
+	// The CPU's interrupt lines.
+	InterruptLines *interrupts = nullptr;
+
+	/**
+	 * @brief Holds or releases the IRQ line.
+	 *
+	 * @param level Whether the mapper is requesting an interrupt.
+	 */
+	void setIRQ(bool level)
+	{
+		if (interrupts != nullptr)
+			interrupts->setIRQ(InterruptLines::IRQ_MAPPER, level);
+	}
 };
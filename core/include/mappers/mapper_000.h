@@ -23,7 +23,7 @@
 // Project Headers.
 #include "../mapper.h"
 
-class Mapper_000 : public Mapper
+class Mapper_000 final : public Mapper
 {
 public:
 	Mapper_000(u8 prgBanks, u8 chrBanks);
@@ -101,3 +101,34 @@ public:
 	 */
 	void loadSaveStateData(std::ifstream& state) override;
 };
+
+//--------------//
+// PPU Mapping  //
+//--------------//
+
+inline bool Mapper_000::ppuMapRead(u16 addr, u32 &mappedAddr)
+{
+	// No PPU mapping required.
+	if (addr >= 0x0000 && addr <= 0x1FFF)
+	{
+		mappedAddr = addr;
+		return true;
+	}
+
+	return false;
+}
+
+inline bool Mapper_000::ppuMapWrite(u16 addr, u32 &mappedAddr)
+{
+	if (addr >= 0x0000 && addr <= 0x1FFF)
+	{
+		// No mapping.
+		if (chrBanks == 0)
+		{
+			mappedAddr = addr;
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -26,7 +26,7 @@
 // Language Headers.
 #include <vector>
 
-class Mapper_001 : public Mapper
+class Mapper_001 final : public Mapper
 {
 public:
 	Mapper_001(u8 prgBanks, u8 chrBanks);
@@ -129,3 +129,66 @@ public:
 	 */
 	void loadSaveStateData(std::ifstream& state) override;
 };
+
+//--------------//
+// PPU Mapping  //
+//--------------//
+
+inline bool Mapper_001::ppuMapRead(u16 addr, u32 &mappedAddr)
+{
+    if (addr < 0x2000)
+    {
+        if (chrBanks == 0)
+        {
+            mappedAddr = addr;
+            return true;
+        }
+        else
+        {
+            if (controlRegister & 0b10000)
+            {
+                // 4KB CHR bank mode.
+                if (addr >= 0x0000 && addr <= 0x0FFF)
+                {
+                    mappedAddr = chrBankSelect4LO * 0x1000 + (addr & 0x0FFF);
+                    return true;
+                }
+
+                if (addr >= 0x1000 && addr <= 0x1FFF)
+                {
+                    mappedAddr = chrBankSelect4HI * 0x1000 + (addr & 0x0FFF);
+                    return true;
+                }
+            }
+            else
+            {
+                // 8KB CHR bank mode.
+                mappedAddr = chrBankSelect8 * 0x2000 + (addr & 0x1FFF);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+inline bool Mapper_001::ppuMapWrite(u16 addr, u32 &mappedAddr)
+{
+    if (addr < 0x2000)
+    {
+        if (chrBanks == 0)
+        {
+            mappedAddr = addr;
+            return true;
+        }
+
+        return true;
+    }
+    else
+        return false;
+}
+
+inline Mirror Mapper_001::mirror()
+{
+    return mirrormode;
+}
@@ -23,7 +23,7 @@
 // Project Headers.
 #include "../mapper.h"
 
-class Mapper_002 : public Mapper
+class Mapper_002 final : public Mapper
 {
 public:
 	Mapper_002(u8 prgBanks, u8 chrBanks);
@@ -105,4 +105,30 @@ public:
 	 * @param state The save state std::ifstream.
 	 */
 	void loadSaveStateData(std::ifstream& state) override;
-};
\ No newline at end of file
+};
+
+//--------------//
+// PPU Mapping  //
+//--------------//
+
+inline bool Mapper_002::ppuMapRead(u16 addr, u32 &mappedAddr)
+{
+    if (addr < 0x2000)
+    {
+        mappedAddr = addr;
+        return true;
+    }
+    else
+        return false;
+}
+
+inline bool Mapper_002::ppuMapWrite(u16 addr, u32 &mappedAddr)
+{
+    // No mapping.
+    if (addr < 0x2000 && chrBanks == 0)
+    {
+        mappedAddr = addr;
+        return true;
+    }
+    return false;
+}
@@ -23,7 +23,7 @@
 // Project Headers.
 #include "../mapper.h"
 
-class Mapper_003 : public Mapper
+class Mapper_003 final : public Mapper
 {
 public:
 	Mapper_003(u8 prgBanks, u8 chrBanks);
@@ -104,4 +104,24 @@ public:
 	 * @param state The save state std::ifstream.
 	 */
 	void loadSaveStateData(std::ifstream& state) override;
-};
\ No newline at end of file
+};
+
+//--------------//
+// PPU Mapping  //
+//--------------//
+
+inline bool Mapper_003::ppuMapRead(u16 addr, u32& mappedAddr)
+{
+	if (addr < 0x2000)
+	{
+		mappedAddr = chrBankSelect * 0x2000 + addr;
+		return true;
+	}
+	else
+		return false;
+}
+
+inline bool Mapper_003::ppuMapWrite(u16 addr, u32& mappedAddr)
+{
+	return false;
+}
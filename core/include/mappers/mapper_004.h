@@ -26,7 +26,7 @@
 // Language Headers.
 #include <vector>
 
-class Mapper_004 : public Mapper
+class Mapper_004 final : public Mapper
 {
 public:
 	Mapper_004(u8 prgBanks, u8 chrBanks);
@@ -86,19 +86,14 @@ public:
 	void reset() override;
 
     /**
-     * @brief Gets the IRQ state of the mapper.
-     */
-    bool irqState() override;
-
-    /**
-     * @brief Clears the IRQ state of the mapper, stopping any IRQ emission.
+     * @brief Performs a per-scanline operation.
      */
-    void irqClear() override;
+    void scanline() override;
 
     /**
-     * @brief Performs a per-scanline operation.
+     * @brief Whether scanline() can raise an IRQ.
      */
-    void scanline() override;
+    bool scanlineIRQ() override;
 
     /**
      * @brief Gets the mirror configuration of the cartridge, if mapper-controlled.
@@ -145,4 +140,64 @@ public:
 	 * @param state The save state std::ifstream.
 	 */
 	void loadSaveStateData(std::ifstream& state) override;
-};
\ No newline at end of file
+};
+
+//--------------//
+// PPU Mapping  //
+//--------------//
+
+inline bool Mapper_004::ppuMapRead(u16 addr, u32& mappedAddr)
+{
+    if (addr >= 0x0000 && addr <= 0x03FF)
+    {
+        mappedAddr = chrBank[0] + (addr & 0x03FF);
+        return true;
+    }
+    else if (addr >= 0x0400 && addr <= 0x07FF)
+    {
+        mappedAddr = chrBank[1] + (addr & 0x03FF);
+        return true;
+    }
+    else if (addr >= 0x0800 && addr <= 0x0BFF)
+    {
+        mappedAddr = chrBank[2] + (addr & 0x03FF);
+        return true;
+    }
+    else if (addr >= 0x0C00 && addr <= 0x0FFF)
+    {
+        mappedAddr = chrBank[3] + (addr & 0x03FF);
+        return true;
+    }
+    else if (addr >= 0x1000 && addr <= 0x13FF)
+    {
+        mappedAddr = chrBank[4] + (addr & 0x03FF);
+        return true;
+    }
+    else if (addr >= 0x1400 && addr <= 0x17FF)
+    {
+        mappedAddr = chrBank[5] + (addr & 0x03FF);
+        return true;
+    }
+    else if (addr >= 0x1800 && addr <= 0x1BFF)
+    {
+        mappedAddr = chrBank[6] + (addr & 0x03FF);
+        return true;
+    }
+    else if (addr >= 0x1C00 && addr <= 0x1FFF)
+    {
+        mappedAddr = chrBank[7] + (addr & 0x03FF);
+        return true;
+    }
+
+    return false;
+}
+
+inline bool Mapper_004::ppuMapWrite(u16 addr, u32& mappedAddr)
+{
+    return false;
+}
+
+inline Mirror Mapper_004::mirror()
+{
+    return mirrorMode;
+}
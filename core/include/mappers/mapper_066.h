@@ -24,7 +24,7 @@
 #include "../mapper.h"
 
 
-class Mapper_066 : public Mapper
+class Mapper_066 final : public Mapper
 {
 public:
 	Mapper_066(u8 prgBanks, u8 chrBanks);
@@ -106,4 +106,24 @@ public:
 	 * @param state The save state std::ifstream.
 	 */
 	void loadSaveStateData(std::ifstream& state) override;
-};
\ No newline at end of file
+};
+
+//--------------//
+// PPU Mapping  //
+//--------------//
+
+inline bool Mapper_066::ppuMapRead(u16 addr, u32& mappedAddr)
+{
+    if (addr < 0x2000)
+    {
+        mappedAddr = chrBankSelect * 0x2000 + addr;
+        return true;
+    }
+    else
+        return false;
+}
+
+inline bool Mapper_066::ppuMapWrite(u16 addr, u32 &mappedAddr)
+{
+    return false;
+}
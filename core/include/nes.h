@@ -27,6 +27,7 @@
 #include "drawable.h"
 
 // Language Headers.
+#include <cstring>
 #include <memory>
 #include <string>
 #include <vector>
@@ -34,8 +35,17 @@
 class OCRNES
 {
 public:
+    // The system owns every component, which the Bus and PPU only refer to,
+    // so they are declared first to outlive it.
+    std::unique_ptr<Cartridge> cart;
+    std::shared_ptr<Drawable> renderer;
+
     Bus bus;
-    std::shared_ptr<Cartridge> cart;
+
+    // Identifies a savestate, and the version of its layout. The version must be
+    // increased whenever any component's savestate data changes.
+    static constexpr char SAVESTATE_MAGIC[4] = { 'O', 'C', 'R', 'S' };
+    static constexpr u32 SAVESTATE_VERSION = 2;
 
     OCRNES() {}
 
@@ -46,7 +56,8 @@ public:
      */
     void setRenderer(std::shared_ptr<Drawable> drawable)
     {
-        bus.ppu.drawable = drawable;
+        renderer = drawable;
+        bus.ppu.connectDrawable(renderer.get());
     }
 
     /**
@@ -58,10 +69,12 @@ public:
      */
     bool loadROM(std::string& path)
     {
-        cart = std::make_shared<Cartridge>();
-        if (cart->load(path))
+        // The current cartridge stays inserted if the ROM can't be loaded.
+        std::unique_ptr<Cartridge> loaded = std::make_unique<Cartridge>();
+        if (loaded->load(path))
         {
-            bus.insertCartridge(cart);
+            cart = std::move(loaded);
+            bus.insertCartridge(cart.get());
             bus.reset();
             return true;
         }
@@ -78,6 +91,9 @@ public:
 
         if (state.is_open())
         {
+            state.write(SAVESTATE_MAGIC, sizeof(SAVESTATE_MAGIC));
+            state.write((char*)&SAVESTATE_VERSION, sizeof(u32));
+
             bus.writeSaveStateData(state);
             bus.cpu.writeSaveStateData(state);
             bus.ppu.writeSaveStateData(state);
@@ -87,6 +103,10 @@ public:
 
     /**
      * @brief Loads a savestate from the given filepath.
+     *
+     * @return true If the load succeeded.
+     * @return false If the savestate does not exist, or was created by a
+     * version of the emulator with a different savestate layout.
      */
     bool loadSaveState(std::string& path)
     {
@@ -94,10 +114,20 @@ public:
 
         if (state.is_open())
         {
+            char magic[4] = {};
+            u32 version = 0;
+            state.read(magic, sizeof(magic));
+            state.read((char*)&version, sizeof(u32));
+
+            // Loading a different layout would leave the system in a garbage state.
+            if (!state || std::memcmp(magic, SAVESTATE_MAGIC, sizeof(magic)) != 0 || version != SAVESTATE_VERSION)
+                return false;
+
             bus.loadSaveStateData(state);
             bus.cpu.loadSaveStateData(state);
             bus.ppu.loadSaveStateData(state);
             bus.cart->loadSaveStateData(state);
+            bus.mapPages();
 
             return true;
         }
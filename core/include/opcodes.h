@@ -0,0 +1,288 @@
+//------------------------------------------------------------------------------//
+//                                                                              //
+//  OCR-NES - An NES Emulator written for the OCR A-Level                       //
+//  Computer Science Programming Project.                                       //
+//                                                                              //
+//  Copyright (C) 2021 - 2022 Conaer Macpherson                                 //
+//                                                                              //
+//------------------------------------------------------------------------------//
+
+/**
+ * @file opcodes.h
+ * @author Conaer Macpherson (Candidate No. 6189)
+ * @brief The 6502 opcode table, shared by every CPU dispatch method.
+ * @version 0.1
+ * @date 2022-03-22
+ *
+ * @copyright Copyright (c) 2021 - 2022
+ *
+ */
+
+#pragma once
+
+//--------------------------------------------------------------------------//
+// Each entry is OP(opcode, instruction, addressing mode, base cycles,      //
+// page cross cycle). The last column is 1 if the instruction takes an      //
+// extra cycle when its addressing mode crosses a page boundary.            //
+// The table is expanded by the CPU both into the instruction lookup table  //
+// and into the cases of the switch dispatcher, so the two can never        //
+// disagree about what an opcode does.                                      //
+//--------------------------------------------------------------------------//
+
+#define OCRNES_OPCODE_TABLE(OP) \
+	OP(0x00, BRK, IMM, 7, 0) \
+	OP(0x01, ORA, IZX, 6, 0) \
+	OP(0x02, XXX, IMP, 2, 0) \
+	OP(0x03, XXX, IMP, 8, 0) \
+	OP(0x04, NOP, IMP, 3, 0) \
+	OP(0x05, ORA, ZP0, 3, 0) \
+	OP(0x06, ASL, ZP0, 5, 0) \
+	OP(0x07, XXX, IMP, 5, 0) \
+	OP(0x08, PHP, IMP, 3, 0) \
+	OP(0x09, ORA, IMM, 2, 0) \
+	OP(0x0A, ASL, IMP, 2, 0) \
+	OP(0x0B, XXX, IMP, 2, 0) \
+	OP(0x0C, NOP, IMP, 4, 0) \
+	OP(0x0D, ORA, ABS, 4, 0) \
+	OP(0x0E, ASL, ABS, 6, 0) \
+	OP(0x0F, XXX, IMP, 6, 0) \
+	OP(0x10, BPL, REL, 2, 0) \
+	OP(0x11, ORA, IZY, 5, 1) \
+	OP(0x12, XXX, IMP, 2, 0) \
+	OP(0x13, XXX, IMP, 8, 0) \
+	OP(0x14, NOP, IMP, 4, 0) \
+	OP(0x15, ORA, ZPX, 4, 0) \
+	OP(0x16, ASL, ZPX, 6, 0) \
+	OP(0x17, XXX, IMP, 6, 0) \
+	OP(0x18, CLC, IMP, 2, 0) \
+	OP(0x19, ORA, ABY, 4, 1) \
+	OP(0x1A, NOP, IMP, 2, 0) \
+	OP(0x1B, XXX, IMP, 7, 0) \
+	OP(0x1C, NOP, IMP, 4, 0) \
+	OP(0x1D, ORA, ABX, 4, 1) \
+	OP(0x1E, ASL, ABX, 7, 0) \
+	OP(0x1F, XXX, IMP, 7, 0) \
+	OP(0x20, JSR, ABS, 6, 0) \
+	OP(0x21, AND, IZX, 6, 0) \
+	OP(0x22, XXX, IMP, 2, 0) \
+	OP(0x23, XXX, IMP, 8, 0) \
+	OP(0x24, BIT, ZP0, 3, 0) \
+	OP(0x25, AND, ZP0, 3, 0) \
+	OP(0x26, ROL, ZP0, 5, 0) \
+	OP(0x27, XXX, IMP, 5, 0) \
+	OP(0x28, PLP, IMP, 4, 0) \
+	OP(0x29, AND, IMM, 2, 0) \
+	OP(0x2A, ROL, IMP, 2, 0) \
+	OP(0x2B, XXX, IMP, 2, 0) \
+	OP(0x2C, BIT, ABS, 4, 0) \
+	OP(0x2D, AND, ABS, 4, 0) \
+	OP(0x2E, ROL, ABS, 6, 0) \
+	OP(0x2F, XXX, IMP, 6, 0) \
+	OP(0x30, BMI, REL, 2, 0) \
+	OP(0x31, AND, IZY, 5, 1) \
+	OP(0x32, XXX, IMP, 2, 0) \
+	OP(0x33, XXX, IMP, 8, 0) \
+	OP(0x34, NOP, IMP, 4, 0) \
+	OP(0x35, AND, ZPX, 4, 0) \
+	OP(0x36, ROL, ZPX, 6, 0) \
+	OP(0x37, XXX, IMP, 6, 0) \
+	OP(0x38, SEC, IMP, 2, 0) \
+	OP(0x39, AND, ABY, 4, 1) \
+	OP(0x3A, NOP, IMP, 2, 0) \
+	OP(0x3B, XXX, IMP, 7, 0) \
+	OP(0x3C, NOP, IMP, 4, 0) \
+	OP(0x3D, AND, ABX, 4, 1) \
+	OP(0x3E, ROL, ABX, 7, 0) \
+	OP(0x3F, XXX, IMP, 7, 0) \
+	OP(0x40, RTI, IMP, 6, 0) \
+	OP(0x41, EOR, IZX, 6, 0) \
+	OP(0x42, XXX, IMP, 2, 0) \
+	OP(0x43, XXX, IMP, 8, 0) \
+	OP(0x44, NOP, IMP, 3, 0) \
+	OP(0x45, EOR, ZP0, 3, 0) \
+	OP(0x46, LSR, ZP0, 5, 0) \
+	OP(0x47, XXX, IMP, 5, 0) \
+	OP(0x48, PHA, IMP, 3, 0) \
+	OP(0x49, EOR, IMM, 2, 0) \
+	OP(0x4A, LSR, IMP, 2, 0) \
+	OP(0x4B, XXX, IMP, 2, 0) \
+	OP(0x4C, JMP, ABS, 3, 0) \
+	OP(0x4D, EOR, ABS, 4, 0) \
+	OP(0x4E, LSR, ABS, 6, 0) \
+	OP(0x4F, XXX, IMP, 6, 0) \
+	OP(0x50, BVC, REL, 2, 0) \
+	OP(0x51, EOR, IZY, 5, 1) \
+	OP(0x52, XXX, IMP, 2, 0) \
+	OP(0x53, XXX, IMP, 8, 0) \
+	OP(0x54, NOP, IMP, 4, 0) \
+	OP(0x55, EOR, ZPX, 4, 0) \
+	OP(0x56, LSR, ZPX, 6, 0) \
+	OP(0x57, XXX, IMP, 6, 0) \
+	OP(0x58, CLI, IMP, 2, 0) \
+	OP(0x59, EOR, ABY, 4, 1) \
+	OP(0x5A, NOP, IMP, 2, 0) \
+	OP(0x5B, XXX, IMP, 7, 0) \
+	OP(0x5C, NOP, IMP, 4, 0) \
+	OP(0x5D, EOR, ABX, 4, 1) \
+	OP(0x5E, LSR, ABX, 7, 0) \
+	OP(0x5F, XXX, IMP, 7, 0) \
+	OP(0x60, RTS, IMP, 6, 0) \
+	OP(0x61, XXX, IMP, 2, 0) \
+	OP(0x62, ADC, IZX, 6, 0) \
+	OP(0x63, XXX, IMP, 8, 0) \
+	OP(0x64, NOP, IMP, 3, 0) \
+	OP(0x65, ADC, ZP0, 3, 0) \
+	OP(0x66, ROR, ZP0, 5, 0) \
+	OP(0x67, XXX, IMP, 5, 0) \
+	OP(0x68, PLA, IMP, 4, 0) \
+	OP(0x69, ADC, IMM, 2, 0) \
+	OP(0x6A, ROR, IMP, 2, 0) \
+	OP(0x6B, XXX, IMP, 2, 0) \
+	OP(0x6C, JMP, IND, 5, 0) \
+	OP(0x6D, ADC, ABS, 4, 0) \
+	OP(0x6E, ROR, ABS, 6, 0) \
+	OP(0x6F, XXX, IMP, 6, 0) \
+	OP(0x70, BVS, REL, 2, 0) \
+	OP(0x71, ADC, IZY, 5, 1) \
+	OP(0x72, XXX, IMP, 2, 0) \
+	OP(0x73, XXX, IMP, 8, 0) \
+	OP(0x74, NOP, IMP, 4, 0) \
+	OP(0x75, ADC, ZPX, 4, 0) \
+	OP(0x76, ROR, ZPX, 6, 0) \
+	OP(0x77, XXX, IMP, 6, 0) \
+	OP(0x78, SEI, IMP, 2, 0) \
+	OP(0x79, ADC, ABY, 4, 1) \
+	OP(0x7A, NOP, IMP, 2, 0) \
+	OP(0x7B, XXX, IMP, 7, 0) \
+	OP(0x7C, NOP, IMP, 4, 0) \
+	OP(0x7D, ADC, ABX, 4, 1) \
+	OP(0x7E, ROR, ABX, 7, 0) \
+	OP(0x7F, XXX, IMP, 7, 0) \
+	OP(0x80, NOP, IMP, 2, 0) \
+	OP(0x81, STA, IZX, 6, 0) \
+	OP(0x82, NOP, IMP, 2, 0) \
+	OP(0x83, XXX, IMP, 6, 0) \
+	OP(0x84, STY, ZP0, 3, 0) \
+	OP(0x85, STA, ZP0, 3, 0) \
+	OP(0x86, STX, ZP0, 3, 0) \
+	OP(0x87, XXX, IMP, 3, 0) \
+	OP(0x88, DEY, IMP, 2, 0) \
+	OP(0x89, NOP, IMP, 2, 0) \
+	OP(0x8A, TXA, IMP, 2, 0) \
+	OP(0x8B, XXX, IMP, 2, 0) \
+	OP(0x8C, STY, ABS, 4, 0) \
+	OP(0x8D, STA, ABS, 4, 0) \
+	OP(0x8E, STX, ABS, 4, 0) \
+	OP(0x8F, XXX, IMP, 4, 0) \
+	OP(0x90, BCC, REL, 2, 0) \
+	OP(0x91, STA, IZY, 6, 0) \
+	OP(0x92, XXX, IMP, 2, 0) \
+	OP(0x93, XXX, IMP, 6, 0) \
+	OP(0x94, STY, ZPX, 4, 0) \
+	OP(0x95, STA, ZPX, 4, 0) \
+	OP(0x96, STX, ZPY, 4, 0) \
+	OP(0x97, XXX, IMP, 4, 0) \
+	OP(0x98, TYA, IMP, 2, 0) \
+	OP(0x99, STA, ABY, 5, 0) \
+	OP(0x9A, TXS, IMP, 2, 0) \
+	OP(0x9B, XXX, IMP, 5, 0) \
+	OP(0x9C, NOP, IMP, 5, 0) \
+	OP(0x9D, STA, ABX, 5, 0) \
+	OP(0x9E, XXX, IMP, 5, 0) \
+	OP(0x9F, XXX, IMP, 5, 0) \
+	OP(0xA0, LDY, IMM, 2, 0) \
+	OP(0xA1, LDA, IZX, 6, 0) \
+	OP(0xA2, LDX, IMM, 2, 0) \
+	OP(0xA3, XXX, IMP, 6, 0) \
+	OP(0xA4, LDY, ZP0, 3, 0) \
+	OP(0xA5, LDA, ZP0, 3, 0) \
+	OP(0xA6, LDX, ZP0, 3, 0) \
+	OP(0xA7, XXX, IMP, 3, 0) \
+	OP(0xA8, TAY, IMP, 2, 0) \
+	OP(0xA9, LDA, IMM, 2, 0) \
+	OP(0xAA, TAX, IMP, 2, 0) \
+	OP(0xAB, XXX, IMP, 2, 0) \
+	OP(0xAC, LDY, ABS, 4, 0) \
+	OP(0xAD, LDA, ABS, 4, 0) \
+	OP(0xAE, LDX, ABS, 4, 0) \
+	OP(0xAF, XXX, IMP, 4, 0) \
+	OP(0xB0, BCS, REL, 2, 0) \
+	OP(0xB1, LDA, IZY, 5, 1) \
+	OP(0xB2, XXX, IMP, 2, 0) \
+	OP(0xB3, XXX, IMP, 5, 0) \
+	OP(0xB4, LDY, ZPX, 4, 0) \
+	OP(0xB5, LDA, ZPX, 4, 0) \
+	OP(0xB6, LDX, ZPY, 4, 0) \
+	OP(0xB7, XXX, IMP, 4, 0) \
+	OP(0xB8, CLV, IMP, 2, 0) \
+	OP(0xB9, LDA, ABY, 4, 1) \
+	OP(0xBA, TSX, IMP, 2, 0) \
+	OP(0xBB, XXX, IMP, 4, 0) \
+	OP(0xBC, LDY, ABX, 4, 1) \
+	OP(0xBD, LDA, ABX, 4, 1) \
+	OP(0xBE, LDX, ABY, 4, 1) \
+	OP(0xBF, XXX, IMP, 4, 0) \
+	OP(0xC0, CPY, IMM, 2, 0) \
+	OP(0xC1, CMP, IZX, 6, 0) \
+	OP(0xC2, NOP, IMP, 2, 0) \
+	OP(0xC3, XXX, IMP, 8, 0) \
+	OP(0xC4, CPY, ZP0, 3, 0) \
+	OP(0xC5, CMP, ZP0, 3, 0) \
+	OP(0xC6, DEC, ZP0, 5, 0) \
+	OP(0xC7, XXX, IMP, 5, 0) \
+	OP(0xC8, INY, IMP, 2, 0) \
+	OP(0xC9, CMP, IMM, 2, 0) \
+	OP(0xCA, DEX, IMP, 2, 0) \
+	OP(0xCB, XXX, IMP, 2, 0) \
+	OP(0xCC, CPY, ABS, 4, 0) \
+	OP(0xCD, CMP, ABS, 4, 0) \
+	OP(0xCE, DEC, ABS, 6, 0) \
+	OP(0xCF, XXX, IMP, 6, 0) \
+	OP(0xD0, BNE, REL, 2, 0) \
+	OP(0xD1, CMP, IZY, 5, 1) \
+	OP(0xD2, XXX, IMP, 2, 0) \
+	OP(0xD3, XXX, IMP, 8, 0) \
+	OP(0xD4, NOP, IMP, 4, 0) \
+	OP(0xD5, CMP, ZPX, 4, 0) \
+	OP(0xD6, DEC, ZPX, 6, 0) \
+	OP(0xD7, XXX, IMP, 6, 0) \
+	OP(0xD8, CLD, IMP, 2, 0) \
+	OP(0xD9, CMP, ABY, 4, 1) \
+	OP(0xDA, NOP, IMP, 2, 0) \
+	OP(0xDB, XXX, IMP, 7, 0) \
+	OP(0xDC, NOP, IMP, 4, 0) \
+	OP(0xDD, CMP, ABX, 4, 1) \
+	OP(0xDE, DEC, ABX, 7, 0) \
+	OP(0xDF, XXX, IMP, 7, 0) \
+	OP(0xE0, CPX, IMM, 2, 0) \
+	OP(0xE1, SBC, IZX, 6, 0) \
+	OP(0xE2, NOP, IMP, 2, 0) \
+	OP(0xE3, XXX, IMP, 8, 0) \
+	OP(0xE4, CPX, ZP0, 3, 0) \
+	OP(0xE5, SBC, ZP0, 3, 0) \
+	OP(0xE6, INC, ZP0, 5, 0) \
+	OP(0xE7, XXX, IMP, 5, 0) \
+	OP(0xE8, INX, IMP, 2, 0) \
+	OP(0xE9, SBC, IMM, 2, 0) \
+	OP(0xEA, NOP, IMP, 2, 0) \
+	OP(0xEB, SBC, IMP, 2, 0) \
+	OP(0xEC, CPX, ABS, 4, 0) \
+	OP(0xED, SBC, ABS, 4, 0) \
+	OP(0xEE, INC, ABS, 6, 0) \
+	OP(0xEF, XXX, IMP, 6, 0) \
+	OP(0xF0, BEQ, REL, 2, 0) \
+	OP(0xF1, SBC, IZY, 5, 1) \
+	OP(0xF2, XXX, IMP, 2, 0) \
+	OP(0xF3, XXX, IMP, 8, 0) \
+	OP(0xF4, NOP, IMP, 4, 0) \
+	OP(0xF5, SBC, ZPX, 4, 0) \
+	OP(0xF6, INC, ZPX, 6, 0) \
+	OP(0xF7, XXX, IMP, 6, 0) \
+	OP(0xF8, SED, IMP, 2, 0) \
+	OP(0xF9, SBC, ABY, 4, 1) \
+	OP(0xFA, NOP, IMP, 2, 0) \
+	OP(0xFB, XXX, IMP, 7, 0) \
+	OP(0xFC, NOP, IMP, 4, 0) \
+	OP(0xFD, SBC, ABX, 4, 1) \
+	OP(0xFE, INC, ABX, 7, 0) \
+	OP(0xFF, XXX, IMP, 7, 0)
@@ -24,6 +24,7 @@
 #include "common.h"
 #include "cartridge.h"
 #include "drawable.h"
+#include "interrupts.h"
 
 // Language Headers.
 #include <memory>
@@ -44,14 +45,14 @@ public:
 	 * @param addr The address.
 	 * @return u8 The read byte.
 	 */
-	u8 cpuRead(u16 addr);
+	u8 cpuRead(u16 addr) { return (this->*specialised.cpuRead)(addr); }
 	/**
 	 * @brief Writes a byte to the Bus at the given memory address.
 	 *
 	 * @param addr The address.
 	 * @param data The byte to write.
 	 */
-	void cpuWrite(u16 addr, u8 data);
+	void cpuWrite(u16 addr, u8 data) { (this->*specialised.cpuWrite)(addr, data); }
 
 	//--------------------------//
 	// PPU Bus Communication	//
@@ -63,6 +64,7 @@ public:
 	 * @param addr The address.
 	 * @return u8 The read byte.
 	 */
+	template <class MapperT = Mapper>
 	u8 ppuRead(u16 addr);
 	/**
 	 * @brief Writes a byte to the PPU Bus at the given memory address.
@@ -70,6 +72,7 @@ public:
 	 * @param addr The address.
 	 * @param data The byte to write.
 	 */
+	template <class MapperT = Mapper>
 	void ppuWrite(u16 addr, u8 data);
 
 	//------------------//
@@ -81,31 +84,116 @@ public:
 	 *
 	 * @param cartridge The cartridge.
 	 */
-	void connectCartridge(const std::shared_ptr<Cartridge> &cartridge);
+	void connectCartridge(Cartridge *cartridge);
+
+	/**
+	 * @brief Connects the renderer, which is passed every row of the next frame.
+	 *
+	 * @param target The renderer.
+	 */
+	void connectDrawable(Drawable *target)
+	{
+		drawable = target;
+		presentedFrame = false;
+	}
+
+	/**
+	 * @brief Connects the CPU's interrupt lines, so the PPU can drive NMI.
+	 *
+	 * @param lines The interrupt lines.
+	 */
+	void connectInterrupts(InterruptLines *lines);
+
+	/**
+	 * @brief Specialises the PPU for the cartridge's mapper, so that
+	 * its accesses to the cartridge are direct calls, which can be inlined.
+	 * Mapper itself may be given for any mapper, calling it through the vtable.
+	 */
+	template <class MapperT>
+	void specialise();
 
 	/**
 	 * @brief Executes 1 PPU clock cycle.
 	 */
-	void clockCycle();
+	void clockCycle() { (this->*specialised.clockCycle)(); }
+
+	/**
+	 * @brief Executes a number of PPU clock cycles.
+	 *
+	 * @param cycles The number of cycles.
+	 */
+	void run(u32 cycles) { (this->*specialised.run)(cycles); }
 
 	/**
 	 * @brief Resets the PPU to a known state.
 	 */
 	void reset();
 
-	bool nmi = false;
+	/**
+	 * @brief Gets the number of PPU cycles until the next event which could
+	 * change what the CPU sees, used to skip idle loops safely.
+	 *
+	 * @param pollingStatus Whether the CPU is reading PPUSTATUS.
+	 * @param irqEnabled Whether the CPU would respond to a mapper IRQ.
+	 * @return u32 The number of PPU cycles which can run before the event.
+	 */
+	u32 cyclesUntilEvent(bool pollingStatus, bool irqEnabled);
+
+	/**
+	 * @brief Gets the number of PPU cycles until the frame is complete. An odd
+	 * frame may skip a cycle, which is assumed until it is known not to.
+	 *
+	 * @return u32 The number of PPU cycles, at most the length of a frame.
+	 */
+	u32 cyclesUntilFrameEnd();
+
+	/**
+	 * @brief Gets the number of PPU cycles until the cycle on which VBlank starts,
+	 * raising an NMI if enabled. Never later than the real cycle.
+	 *
+	 * @return u32 The number of PPU cycles.
+	 */
+	u32 cyclesUntilVBlank();
+
+	/**
+	 * @brief Gets the number of PPU cycles until the cycle on which the mapper's
+	 * scanline counter may next be clocked. Never later than the real cycle.
+	 *
+	 * @return u32 The number of PPU cycles.
+	 */
+	u32 cyclesUntilScanlineClock();
+
+	/**
+	 * @brief Gets the number of PPU cycles until the cycle on which sprites are
+	 * next evaluated, the only time OAM is read. Never later than the real cycle.
+	 *
+	 * @return u32 The number of PPU cycles.
+	 */
+	u32 cyclesUntilSpriteEvaluation();
+
 	bool scanlineTrigger = false;
 
 	//------------------//
 	// Renderer Data    //
 	//------------------//
 
-	// All renderers inherit from Drawable, implementing setPixel().
-	std::shared_ptr<Drawable> drawable;
+	// All renderers inherit from Drawable, which is passed each frame.
+	// Owned by the system, which outlives the PPU's use of it.
+	Drawable *drawable = nullptr;
 
 	// The screen colour palette.
 	RGBAColor palScreen[0x40];
 
+	// Every pixel of the frame, recorded as it is drawn, with the index into
+	// palScreen in bits 0 - 5 and the colour emphasis bits of the mask register
+	// (red, green, blue) in bits 6 - 8. The screen palette has no emphasised
+	// colours, so the conversion to RGBA ignores them for now. Left as it is
+	// when the frame isn't rendered.
+	u16 frameIndices[240][256];
+
+	// The frame in RGBA, converted from its indices once it is drawn.
+	RGBAColor frameColours[240][256];
+
 	/**
 	 * @brief Gets the screen colour for a palette and pixel.
 	 *
@@ -113,12 +201,26 @@ public:
 	 * @param pixel The pixel index into the palette.
 	 * @return RGBAColor& The RGBAColor screen colour.
 	 */
+	template <class MapperT = Mapper>
 	RGBAColor &getColorFromPalMemory(u8 palette, u8 pixel);
 
 	//----------------------//
 	// Emulation Variables	//
 	//----------------------//
 
+	/**
+	 * @brief How run() draws the visible scanlines.
+	 */
+	enum class Rendering
+	{
+		DOT,		// Every cycle is clocked through the fetch and shift pipeline.
+		SCANLINE,	// Lines are drawn in one pass where nothing can access the PPU part way through.
+	};
+
+	// Both produce identical results, but drawing a line in one pass avoids
+	// shifting every pixel through the pipeline one cycle at a time.
+	Rendering renderMode = Rendering::SCANLINE;
+
 	// For one-frame-at-a-time emulation.
 	bool frameComplete = false;
 	// Facilitates frameskip.
@@ -266,7 +368,138 @@ private:
 	bool spriteZeroBeingRendered = false;
 
 	// Cartridge pointer.
-	std::shared_ptr<Cartridge> cart;
+	Cartridge *cart = nullptr;
+
+	// The CPU's interrupt lines.
+	InterruptLines *interrupts = nullptr;
+
+	//------------------//
+	// Specialisation	//
+	//------------------//
+
+	/**
+	 * @brief The entry points of the PPU, specialised for the cartridge's mapper.
+	 */
+	struct Specialisation
+	{
+		u8 (PPU::*cpuRead)(u16 addr);
+		void (PPU::*cpuWrite)(u16 addr, u8 data);
+		void (PPU::*clockCycle)();
+		void (PPU::*run)(u32 cycles);
+	} specialised;
+
+	template <class MapperT>
+	u8 cpuReadFor(u16 addr);
+	template <class MapperT>
+	void cpuWriteFor(u16 addr, u8 data);
+	template <class MapperT>
+	void clockCycleFor();
+	template <class MapperT>
+	void runFor(u32 cycles);
+
+	/**
+	 * @brief Gets the colour index for a palette and pixel, reading palette
+	 * memory directly rather than through the PPU bus.
+	 *
+	 * @param palette The palette index.
+	 * @param pixel The pixel index into the palette.
+	 * @return u8 The index into palScreen.
+	 */
+	u8 getColorIndex(u8 palette, u8 pixel)
+	{
+		// Entry 0 of each sprite palette mirrors that of the BG palette.
+		u8 addr = (palette << 2) | pixel;
+		if ((addr & 0x13) == 0x10)
+			addr &= 0x0F;
+
+		return tblPalette[addr] & (mask.greyscale ? 0x30 : 0x3F);
+	}
+
+	/**
+	 * @brief Gets the colour emphasis bits of the mask register, in the bits
+	 * of frameIndices they are recorded in.
+	 */
+	u16 getEmphasis() const { return (u16)(mask.reg & 0xE0) << 1; }
+
+	// The indices of the frame last passed to the renderer, and which rows of
+	// the frame differ from them.
+	u16 presentedIndices[240][256];
+	bool dirtyRows[240];
+	bool presentedFrame = false;
+
+	/**
+	 * @brief Composes a visible scanline from its BG and sprite pixels, many
+	 * pixels at a time where the host has SIMD instructions.
+	 *
+	 * @param bgPixel The 2-bit BG pixel at each X.
+	 * @param bgPal The BG palette at each X.
+	 * @param fgEntry The palette entry of the sprite pixel at each X, or 0 if transparent.
+	 * @param fgFront 0xFF where the sprite pixel is in front of the BG, otherwise 0.
+	 * @param fgZero 0xFF where the sprite pixel may hit sprite zero, otherwise 0.
+	 * @param colours The colour index of each of the 32 palette entries.
+	 * @param line The 256 colour indices of the scanline.
+	 * @return true If sprite zero hit an opaque BG pixel.
+	 */
+	static bool composeScanline(const u8 *bgPixel, const u8 *bgPal, const u8 *fgEntry, const u8 *fgFront, const u8 *fgZero, const u8 *colours, u8 *line);
+
+	/**
+	 * @brief Converts the frame's colour indices to RGBA, and passes it to
+	 * the renderer. Called once the last visible scanline is drawn.
+	 */
+	void presentFrame();
+
+	//----------------------//
+	// Scanline Renderer	//
+	//----------------------//
+
+	// The cycles of a visible scanline drawn by drawScanline(), from cycle 0,
+	// and those after them clocked by finishScanline().
+	static constexpr u16 VISIBLE_CYCLES = 257;
+	static constexpr u16 HBLANK_CYCLES = 341 - VISIBLE_CYCLES;
+
+	/**
+	 * @brief Draws the visible cycles of the current scanline in one pass, leaving
+	 * the PPU exactly as clocking them would. Must start on cycle 0.
+	 */
+	template <class MapperT>
+	void drawScanline();
+
+	/**
+	 * @brief Runs the remaining cycles of the current visible scanline in one
+	 * pass, evaluating and loading the next line's sprites and prefetching its
+	 * first tiles. Must start on cycle VISIBLE_CYCLES.
+	 */
+	template <class MapperT>
+	void finishScanline();
+
+	/**
+	 * @brief Gets the number of PPU cycles until the PPU reaches a position,
+	 * assuming the cycle skipped by odd frames is skipped if it is passed.
+	 *
+	 * @param position Cycles from the start of the pre-render scanline.
+	 * @return u32 The number of PPU cycles.
+	 */
+	u32 cyclesUntilPosition(u32 position);
+
+	/**
+	 * @brief Gets the number of PPU cycles until the PPU next reaches a cycle
+	 * of any scanline in a range.
+	 *
+	 * @param lineCycle The cycle within the scanline.
+	 * @param first The first scanline, from -1 for the pre-render scanline.
+	 * @param last The last scanline.
+	 * @return u32 The number of PPU cycles.
+	 */
+	u32 cyclesUntilLineCycle(u16 lineCycle, s16 first, s16 last);
+
+	/**
+	 * @brief Drives the NMI line, which is held while in VBlank with NMI enabled.
+	 */
+	void updateNMI()
+	{
+		if (interrupts != nullptr)
+			interrupts->setNMI(status.vBlank && control.enableNMI);
+	}
 
 public:
 	// OAM as a u8* for easy byte access during DMA.
@@ -306,6 +539,49 @@ public:
 	 */
 	void scUpdateShifters();
 
+	/**
+	 * @brief Fetch the ID of the next BG tile from the nametable.
+	 */
+	template <class MapperT>
+	void scFetchTileID();
+
+	/**
+	 * @brief Fetch the palette of the next BG tile from the attribute table.
+	 */
+	template <class MapperT>
+	void scFetchTileAttrib();
+
+	/**
+	 * @brief Fetch the low bit plane of the next BG tile's row.
+	 */
+	template <class MapperT>
+	void scFetchTileLSB();
+
+	/**
+	 * @brief Fetch the high bit plane of the next BG tile's row.
+	 */
+	template <class MapperT>
+	void scFetchTileMSB();
+
+	/**
+	 * @brief Fetch both bit planes of the next BG tile's row.
+	 *
+	 * @return const ChrRow* The decoded row, or nullptr if it isn't in CHR memory.
+	 */
+	template <class MapperT>
+	const ChrRow *scFetchTileRow();
+
+	/**
+	 * @brief Decide the sprites visible on the next scanline from OAM.
+	 */
+	void scEvaluateSprites();
+
+	/**
+	 * @brief Load the sprite shifters with the rows of the sprites on the next scanline.
+	 */
+	template <class MapperT>
+	void scLoadSpriteShifters();
+
 	/**
 	 * @brief Flips a byte.
 	 *
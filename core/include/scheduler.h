@@ -0,0 +1,128 @@
+//------------------------------------------------------------------------------//
+//                                                                              //
+//  OCR-NES - An NES Emulator written for the OCR A-Level                       //
+//  Computer Science Programming Project.                                       //
+//                                                                              //
+//  Copyright (C) 2021 - 2022 Conaer Macpherson                                 //
+//                                                                              //
+//------------------------------------------------------------------------------//
+
+/**
+ * @file scheduler.h
+ * @author Conaer Macpherson (Candidate No. 6189)
+ * @brief Future events on the master clock, which the Bus runs up to.
+ * @version 0.1
+ * @date 2022-03-22
+ *
+ * @copyright Copyright (c) 2021 - 2022
+ *
+ */
+
+#pragma once
+
+// Project Headers.
+#include "common.h"
+
+//------------------------------------------------------------------------------//
+// Each kind of event has a single slot holding its master clock timestamp, so  //
+// rescheduling an event replaces it. There are only a handful of kinds, so the //
+// earliest is found by scanning the slots whenever one changes, and is cached  //
+// for the Bus to compare against on every cycle.                               //
+//------------------------------------------------------------------------------//
+
+class Scheduler
+{
+public:
+	/**
+	 * @brief The kinds of event, in the order they are handled when due at once.
+	 */
+	enum Event : u8
+	{
+		// An OAM DMA transfer is ready to start.
+		DMA,
+		// The PPU starts VBlank, which may raise an NMI.
+		VBLANK,
+		// The PPU clocks the mapper's scanline counter, which may raise an IRQ.
+		SCANLINE,
+		// The PPU finishes the frame.
+		FRAME_END,
+
+		NUM_EVENTS
+	};
+
+	// The timestamp of an event which isn't scheduled.
+	static constexpr u64 NEVER = ~(u64)0;
+
+	Scheduler() { clear(); }
+
+	/**
+	 * @brief Schedules an event, replacing any earlier timestamp for it.
+	 *
+	 * @param event The event.
+	 * @param timestamp The master clock timestamp it is due at.
+	 */
+	void schedule(Event event, u64 timestamp)
+	{
+		due[event] = timestamp;
+		if (timestamp < nextTimestamp)
+			nextTimestamp = timestamp;
+		else
+			update();
+	}
+
+	/**
+	 * @brief Cancels an event.
+	 *
+	 * @param event The event.
+	 */
+	void cancel(Event event)
+	{
+		due[event] = NEVER;
+		update();
+	}
+
+	/**
+	 * @brief Cancels every event.
+	 */
+	void clear()
+	{
+		for (u8 i = 0; i < NUM_EVENTS; i++)
+			due[i] = NEVER;
+		nextTimestamp = NEVER;
+	}
+
+	/**
+	 * @brief Gets the timestamp of the earliest event.
+	 */
+	u64 next() const { return nextTimestamp; }
+
+	/**
+	 * @brief Removes the earliest event.
+	 *
+	 * @return Event The event.
+	 */
+	Event pop()
+	{
+		u8 i = 0;
+		while (i < NUM_EVENTS - 1 && due[i] != nextTimestamp)
+			i++;
+
+		cancel((Event)i);
+		return (Event)i;
+	}
+
+private:
+	u64 due[NUM_EVENTS];
+	u64 nextTimestamp = NEVER;
+
+	/**
+	 * @brief Finds the earliest event after the slots have changed.
+	 */
+	void update()
+	{
+		nextTimestamp = NEVER;
+		for (u8 i = 0; i < NUM_EVENTS; i++)
+			if (due[i] < nextTimestamp)
+				nextTimestamp = due[i];
+	}
+};
@@ -0,0 +1,129 @@
+//------------------------------------------------------------------------------//
+//                                                                              //
+//  OCR-NES - An NES Emulator written for the OCR A-Level                       //
+//  Computer Science Programming Project.                                       //
+//                                                                              //
+//  Copyright (C) 2021 - 2022 Conaer Macpherson                                 //
+//                                                                              //
+//------------------------------------------------------------------------------//
+
+/**
+ * @file trace.h
+ * @author Conaer Macpherson (Candidate No. 6189)
+ * @brief A ring buffer of the last instructions the CPU executed, for debugging.
+ * @version 0.1
+ * @date 2022-03-22
+ *
+ * @copyright Copyright (c) 2021 - 2022
+ *
+ */
+
+#pragma once
+
+// Project Headers.
+#include "common.h"
+
+// Language Headers.
+#include <atomic>
+#include <vector>
+
+//------------------------------------------------------------------------------//
+// The trace is only kept when the core is built with the OCRNES_CPU_TRACE      //
+// CMake option, which sets the number of instructions it holds. Otherwise it   //
+// holds none, and the CPU compiles out every call to record one, so tracing    //
+// costs nothing unless it is built in.                                         //
+//------------------------------------------------------------------------------//
+
+#ifndef OCRNES_CPU_TRACE_LENGTH
+#define OCRNES_CPU_TRACE_LENGTH 0
+#endif
+
+/**
+ * @brief An executed instruction, with the registers before it was executed.
+ */
+struct TraceEntry
+{
+	// The CPU cycle the instruction started on.
+	u64 cycle = 0;
+	u16 pc = 0x0000;
+	u8 opcode = 0x00;
+	u8 operand[2] = { 0x00, 0x00 };
+	u8 a = 0x00;
+	u8 x = 0x00;
+	u8 y = 0x00;
+	u8 sp = 0x00;
+	u8 status = 0x00;
+};
+
+/**
+ * @brief Holds the last N instructions recorded. Only the emulation thread
+ * records, so another thread may take a snapshot without locking, although
+ * the oldest entries may be overwritten while it does.
+ *
+ * @tparam N The number of instructions held, a power of 2, or 0 to hold none.
+ */
+template <size_t N>
+class TraceBuffer
+{
+	static_assert((N & (N - 1)) == 0, "The trace length must be a power of 2.");
+
+public:
+	static constexpr bool ENABLED = true;
+
+	/**
+	 * @brief Records an instruction, replacing the oldest if the buffer is full.
+	 *
+	 * @param entry The instruction.
+	 */
+	void record(const TraceEntry& entry)
+	{
+		u64 index = count.load(std::memory_order_relaxed);
+		entries[index & (N - 1)] = entry;
+
+		// Publish the entry only once it has been written.
+		count.store(index + 1, std::memory_order_release);
+	}
+
+	/**
+	 * @brief Copies the instructions held.
+	 *
+	 * @return std::vector<TraceEntry> The instructions, oldest first.
+	 */
+	std::vector<TraceEntry> snapshot() const
+	{
+		u64 end = count.load(std::memory_order_acquire);
+		u64 start = end > N ? end - N : 0;
+
+		std::vector<TraceEntry> copy;
+		copy.reserve(end - start);
+		for (u64 i = start; i < end; i++)
+			copy.push_back(entries[i & (N - 1)]);
+
+		return copy;
+	}
+
+	/**
+	 * @brief Discards every instruction held.
+	 */
+	void clear() { count.store(0, std::memory_order_release); }
+
+private:
+	TraceEntry entries[N];
+
+	// The number of instructions ever recorded.
+	std::atomic<u64> count { 0 };
+};
+
+/**
+ * @brief A trace which holds nothing, when tracing isn't built in.
+ */
+template <>
+class TraceBuffer<0>
+{
+public:
+	static constexpr bool ENABLED = false;
+
+	void record(const TraceEntry& entry) {}
+	std::vector<TraceEntry> snapshot() const { return {}; }
+	void clear() {}
+};
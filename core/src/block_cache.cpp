@@ -0,0 +1,303 @@
+//------------------------------------------------------------------------------//
+//                                                                              //
+//  OCR-NES - An NES Emulator written for the OCR A-Level                       //
+//  Computer Science Programming Project.                                       //
+//                                                                              //
+//  Copyright (C) 2021 - 2022 Conaer Macpherson                                 //
+//                                                                              //
+//------------------------------------------------------------------------------//
+
+/**
+ * @file block_cache.cpp
+ * @author Conaer Macpherson (Candidate No. 6189)
+ * @brief A cache of pre-decoded straight-line runs of 6502 code.
+ * @version 0.1
+ * @date 2022-03-22
+ *
+ * @copyright Copyright (c) 2021 - 2022
+ *
+ */
+
+#include <block_cache.h>
+#include <bus.h>
+#include <cpu.h>
+#include <opcodes.h>
+
+// The length of an instruction in bytes for each addressing mode.
+static constexpr u8 LENGTH_IMP = 1, LENGTH_IMM = 2, LENGTH_ZP0 = 2;
+static constexpr u8 LENGTH_ZPX = 2, LENGTH_ZPY = 2, LENGTH_REL = 2;
+static constexpr u8 LENGTH_ABS = 3, LENGTH_ABX = 3, LENGTH_ABY = 3;
+static constexpr u8 LENGTH_IND = 3, LENGTH_IZX = 2, LENGTH_IZY = 2;
+
+static constexpr u8 instructionLength[256] = {
+#define OP(opcode, impl, addrmode, cycles, pagecross) LENGTH_##addrmode,
+	OCRNES_OPCODE_TABLE(OP)
+#undef OP
+};
+
+/**
+ * @brief Whether an instruction may change the flow of control, ending a block.
+ */
+static constexpr bool endsBlock(u8 opcode)
+{
+	// Conditional branches.
+	if ((opcode & 0x1F) == 0x10)
+		return true;
+
+	switch (opcode)
+	{
+	case 0x00:	// BRK
+	case 0x20:	// JSR
+	case 0x28:	// PLP, which may enable a pending IRQ
+	case 0x40:	// RTI
+	case 0x4C:	// JMP abs
+	case 0x58:	// CLI, which may enable a pending IRQ
+	case 0x60:	// RTS
+	case 0x6C:	// JMP ind
+		return true;
+	default:
+		return false;
+	}
+}
+
+BlockCache::BlockCache() : blocks(NUM_BLOCKS) {}
+
+//------------------//
+// Cache Interface	//
+//------------------//
+
+BlockCache::Block* BlockCache::lookup(u16 pc)
+{
+	if (stale)
+		flush();
+
+	u32 tag = 0;
+	u32 generation = 0;
+	// Instructions must lie entirely before this address, so that
+	// the block is covered by a single tag and generation.
+	u32 end = 0;
+	s16 page = -1;
+
+	if (pc <= 0x1FFF)
+	{
+		// System RAM, mirrored every 2KB.
+		page = (pc & 0x07FF) >> 8;
+		tag = 0x80000000 | (pc & 0x07FF);
+		end = (pc & 0xFF00) + 0x0100;
+	}
+	else if (pc <= 0x5FFF)
+		// Reads from I/O registers can have side effects, so never cache them.
+		return nullptr;
+	else if (pc <= 0x7FFF)
+	{
+		// Cartridge RAM.
+		page = 8 + ((pc & 0x1FFF) >> 8);
+		tag = 0x40000000 | (pc & 0x1FFF);
+		end = (pc & 0xFF00) + 0x0100;
+	}
+	else
+	{
+		// PRG ROM, identified by its offset so that code in
+		// a bank survives the bank being switched out and in.
+		u32 base = prgPage[(pc >> 13) & 0x03];
+		if (base == UNMAPPED)
+			return nullptr;
+
+		tag = base + (pc & 0x1FFF);
+		generation = romGeneration;
+		end = (pc & 0xE000) + 0x2000;
+	}
+
+	if (page >= 0)
+		generation = pageGeneration[page];
+
+	Block& block = blocks[(pc ^ (tag >> 13)) & (NUM_BLOCKS - 1)];
+
+	if (block.count == 0 || block.pc != pc || block.tag != tag || block.generation != generation)
+	{
+		block.tag = tag;
+		block.generation = generation;
+		decode(block, pc, end);
+
+		if (page >= 0 && block.count > 0)
+			codePages |= (u64)1 << page;
+	}
+
+	return block.count > 0 ? &block : nullptr;
+}
+
+void BlockCache::discardCompiled()
+{
+	for (Block& block : blocks)
+		block.compiled = nullptr;
+}
+
+//------------------//
+// Cache Internals	//
+//------------------//
+
+bool BlockCache::writeCartridge(u16 addr)
+{
+	if (addr <= 0x7FFF)
+		// Cartridge RAM.
+		return writeCodePage(8 + ((addr & 0x1FFF) >> 8));
+	else
+		// A mapper register or PRG ROM.
+		return (this->*refreshPrgMapFor)();
+}
+
+template <class MapperT>
+bool BlockCache::refreshPrgMap()
+{
+	bool changed = false;
+
+	// Some mappers allow writes to PRG ROM, which invalidates every block decoded from it.
+	if (bus->cart->getPrgWriteCount() != prgWriteCount)
+	{
+		prgWriteCount = bus->cart->getPrgWriteCount();
+		romGeneration++;
+		changed = true;
+	}
+
+	// The general specialisation is used until a cartridge is loaded, when there may be no mapper.
+	bool mapped = bus->cart->getMapper() != nullptr;
+
+	for (u8 i = 0; i < 4; i++)
+	{
+		u32 mappedAddr = 0;
+		u8 data = 0x00;
+		u32 base = UNMAPPED;
+
+		if (mapped && bus->cart->as<MapperT>().cpuMapRead(0x8000 + i * 0x2000, mappedAddr, data))
+			base = mappedAddr;
+
+		if (base != prgPage[i])
+		{
+			prgPage[i] = base;
+			changed = true;
+		}
+	}
+
+	return changed;
+}
+
+void BlockCache::flush()
+{
+	for (Block& block : blocks)
+		block.count = 0;
+
+	codePages = 0;
+	(this->*refreshPrgMapFor)();
+	stale = false;
+}
+
+void BlockCache::decode(Block& block, u16 pc, u32 end)
+{
+	block.pc = pc;
+	block.count = 0;
+	block.executions = 0;
+	block.compiled = nullptr;
+
+	u32 addr = pc;
+
+	while (block.count < MAX_BLOCK_LENGTH && addr < end)
+	{
+		Entry& entry = block.entries[block.count];
+
+		// The instruction must not extend past the end of its page.
+		entry.opcode = bus->cpuRead(addr);
+		entry.length = instructionLength[entry.opcode];
+		if (addr + entry.length > end)
+			break;
+
+		entry.pc = addr;
+		entry.fused = 0;
+		entry.operand = 0x0000;
+		if (entry.length >= 2)
+			entry.operand = bus->cpuRead(addr + 1);
+		if (entry.length == 3)
+			entry.operand |= (u16)bus->cpuRead(addr + 2) << 8;
+
+		// Frequent pairs of instructions are run together, unless the
+		// previous instruction is already the second of a pair.
+		if (block.count > 0 && (block.count < 2 || block.entries[block.count - 2].fused == 0))
+			block.entries[block.count - 1].fused = CPU::findFused(block.entries[block.count - 1], entry);
+
+		block.count++;
+		addr += entry.length;
+
+		if (endsBlock(entry.opcode))
+			break;
+	}
+
+	block.idle = findIdle(block);
+}
+
+BlockCache::Idle BlockCache::findIdle(const Block& block)
+{
+	if (block.count == 0)
+		return NOT_IDLE;
+
+	// The block must end by jumping back to its start.
+	const Entry& last = block.entries[block.count - 1];
+	u16 next = last.pc + last.length;
+
+	if ((last.opcode & 0x1F) == 0x10)
+	{
+		if ((u16)(next + (s8)last.operand) != block.pc)
+			return NOT_IDLE;
+	}
+	else if (last.opcode != 0x4C || last.operand != block.pc)
+		return NOT_IDLE;
+
+	Idle idle = IDLE;
+
+	for (u8 i = 0; i + 1 < block.count; i++)
+	{
+		const Entry& entry = block.entries[i];
+
+		switch (entry.opcode)
+		{
+		// Loads, compares and bit tests which only change registers and flags.
+		case 0xA9: case 0xA2: case 0xA0:	// LDA/LDX/LDY imm
+		case 0xC9: case 0xE0: case 0xC0:	// CMP/CPX/CPY imm
+		case 0x29: case 0x09:				// AND/ORA imm
+		case 0xEA:							// NOP
+		case 0xA5: case 0xA6: case 0xA4:	// LDA/LDX/LDY zp
+		case 0xC5: case 0xE4: case 0xC4:	// CMP/CPX/CPY zp
+		case 0x24: case 0x25: case 0x05:	// BIT/AND/ORA zp
+			break;
+
+		case 0xAD: case 0xAE: case 0xAC:	// LDA/LDX/LDY abs
+		case 0xCD: case 0xEC: case 0xCC:	// CMP/CPX/CPY abs
+		case 0x2C: case 0x2D: case 0x0D:	// BIT/AND/ORA abs
+			// System RAM and cartridge memory can be read freely.
+			if (entry.operand <= 0x1FFF || entry.operand >= 0x6000)
+				break;
+
+			// Of the I/O registers, only PPUSTATUS is safe to poll.
+			if (entry.operand <= 0x3FFF && (entry.operand & 0x0007) == 0x0002)
+			{
+				idle = IDLE_POLLS_STATUS;
+				break;
+			}
+
+			return NOT_IDLE;
+
+		default:
+			return NOT_IDLE;
+		}
+	}
+
+	return idle;
+}
+
+//------------------//
+// Specialisation	//
+//------------------//
+
+// Every mapper the cartridge can load, and Mapper itself for any of them.
+template bool BlockCache::refreshPrgMap<Mapper>();
+#define MAPPER(id, MapperT) template bool BlockCache::refreshPrgMap<MapperT>();
+OCRNES_MAPPER_TABLE(MAPPER)
+#undef MAPPER
@@ -1,83 +1,243 @@
 #include <bus.h>
 
+// Language Headers.
+#include <cassert>
+#include <cstring>
+
 Bus::Bus()
 {
-	cart = std::make_shared<Cartridge>();
     // Connect the CPU to the interconnect bus.
-    cpu.linkInterconnect(this);;
+    cpu.linkInterconnect(this);
+    // The PPU drives the NMI line.
+    ppu.connectInterrupts(&interrupts);
+
+	// Power on with RAM cleared, so the system always starts the same way.
+	std::memset(cpuRAM, 0, sizeof(cpuRAM));
+	std::memset(controller, 0, sizeof(controller));
+	std::memset(controllerStateCache, 0, sizeof(controllerStateCache));
+
+	// Each device handles its own range of the address space.
+	mapDevice(0x0000, 0x1FFF, &Bus::readRAM, &Bus::writeRAM);
+	mapDevice(0x2000, 0x3FFF, &Bus::readPPU, &Bus::writePPU);
+	mapDevice(0x4000, 0x40FF, &Bus::readIO, &Bus::writeIO);
+
+	// APU (not implemented).
+	for (u16 addr = 0x4000; addr <= 0x401F; addr++)
+		mapRegister(addr, &Bus::readOpenBus, &Bus::writeIgnored);
+
+	mapRegister(0x4014, &Bus::readOpenBus, &Bus::writeDMA);
+	mapRegister(0x4016, &Bus::readController, &Bus::writeController);
+	mapRegister(0x4017, &Bus::readController, &Bus::writeIgnored);
+
+	// The cartridge, until one is inserted with a known mapper.
+	specialise<Mapper>();
+    mapPages();
 }
 
 //--------------------------//
-// Interconnect Bus R/W		//
+// Devices					//
 //--------------------------//
 
-void Bus::cpuWrite(u16 addr, u8 data)
-{
-	// Cartridge can stop the write.
-    if (cart->cpuWrite(addr, data)) {}
-	if (addr >= 0x0000 && addr <= 0x1FFF)
-        // System RAM, mirrored every 2KB.
-		cpuRAM[addr & 0x07FF] = data;
-	else if (addr >= 0x2000 && addr <= 0x3FFF)
-        // PPU, mirrored every 8 bytes.
-		ppu.cpuWrite(addr & 0x0007, data);
-    // APU (not implemented).
-	else if ((addr >= 0x4000 && addr <= 0x4013) || addr == 0x4015 || addr == 0x4017) {}
-	else if (addr == 0x4014)
+u8 Bus::readPPU(u16 addr)
+{
+	// The PPU must have caught up to see when its registers are read.
+	syncPPU();
+	return ppu.cpuRead(addr & 0x0007);
+}
+
+void Bus::writePPU(u16 addr, u8 data)
+{
+	syncPPU();
+	ppu.cpuWrite(addr & 0x0007, data);
+
+	// Compiled code doesn't sample the interrupt lines, so must be left if
+	// the write raised an interrupt, e.g. by enabling NMI during VBlank.
+	if (interrupts.active())
+		cpu.exitBlock();
+}
+
+u8 Bus::readIO(u16 addr)
+{
+	return (this->*ioReadHandlers[addr & 0x00FF])(addr);
+}
+
+void Bus::writeIO(u16 addr, u8 data)
+{
+	(this->*ioWriteHandlers[addr & 0x00FF])(addr, data);
+}
+
+void Bus::writeDMA(u16 addr, u8 data)
+{
+	// The PPU must see everything before the transfer starts.
+	syncPPU();
+
+	dmaPage = data;
+	dmaAddr = 0x00;
+	dmaInProgress = true;
+
+	// The transfer takes over from the CPU from the next cycle.
+	scheduler.schedule(Scheduler::DMA, cpuTimestamp() + 1);
+
+	if (cpuRunning)
+	{
+		cpuStopped = true;
+		cpuStopTick = cpuTimestamp();
+		cpu.stopRun();
+	}
+}
+
+u8 Bus::readController(u16 addr)
+{
+	// MSB of the controller status.
+	u8 data = (controllerStateCache[addr & 0x0001] & 0x80) > 0;
+	controllerStateCache[addr & 0x0001] <<= 1;
+	return data;
+}
+
+void Bus::writeController(u16 addr, u8 data)
+{
+	// Set the internal controller state.
+	controllerStateCache[addr & 0x0001] = controller[addr & 0x0001];
+}
+
+template <class MapperT>
+u8 Bus::readCartridge(u16 addr)
+{
+	u8 data = 0x00;
+	cart->cpuRead<MapperT>(addr, data);
+	return data;
+}
+
+template <class MapperT>
+void Bus::writeCartridge(u16 addr, u8 data)
+{
+	// The mapper may switch CHR banks or acknowledge an IRQ,
+	// so the PPU must see everything before the write.
+	syncPPU();
+	cart->cpuWrite<MapperT>(addr, data);
+
+	// The write may have switched PRG banks.
+	mapPrgPages<MapperT>(0x60);
+
+	if (interrupts.active())
+		cpu.exitBlock();
+}
+
+//--------------//
+// Page Table	//
+//--------------//
+
+void Bus::mapDevice(u16 first, u16 last, ReadHandler read, WriteHandler write)
+{
+	for (u16 i = first >> 8; i <= last >> 8; i++)
 	{
-        // Writing to this address initiates a DMA transfer.
-		dmaPage = data;
-		dmaAddr = 0x00;
-		dmaInProgress = true;
+		// The CPU accesses the zero page and stack in RAM directly, so
+		// neither the cartridge nor any other device may claim them.
+		assert(i > 0x01 || (read == &Bus::readRAM && write == &Bus::writeRAM));
+
+		pages[i].readHandler = read;
+		pages[i].writeHandler = write;
 	}
-	else if (addr >= 0x4016 && addr <= 0x4017)
-        // Set the internal controller state.
-		controllerStateCache[addr & 0x0001] = controller[addr & 0x0001];
-}
-
-u8 Bus::cpuRead(u16 addr)
-{
-    u8 data = 0x00;
-
-    // Cartridge can stop the read.
-	if (cart->cpuRead(addr, data)) {}
-    else if (addr >= 0x0000 && addr <= 0x1FFF)
-		// System RAM, mirrored every 2KB.
-		data = cpuRAM[addr & 0x07FF];
-	else if (addr >= 0x2000 && addr <= 0x3FFF)
-		// PPU, mirrored every 8 bytes.
-		data = ppu.cpuRead(addr & 0x0007);
-    // APU (not implemented).
-	else if (addr == 0x4015) {}
-	else if (addr >= 0x4016 && addr <= 0x4017)
+}
+
+void Bus::mapRegister(u16 addr, ReadHandler read, WriteHandler write)
+{
+	assert(addr >= 0x4000 && addr <= 0x40FF);
+	ioReadHandlers[addr & 0x00FF] = read;
+	ioWriteHandlers[addr & 0x00FF] = write;
+}
+
+void Bus::mapPages(u16 first)
+{
+	// System RAM, mirrored every 2KB. Nothing else below the
+	// cartridge's space is memory, so is left to its device's handlers.
+	for (u16 i = first; i < 0x60; i++)
 	{
-		// MSB of the controller status.
-		data = (controllerStateCache[addr & 0x0001] & 0x80) > 0;
-		controllerStateCache[addr & 0x0001] <<= 1;
+		u16 addr = i << 8;
+		pages[i].read = addr <= 0x1FFF ? &cpuRAM[addr & 0x07FF] : nullptr;
+		pages[i].write = addr <= 0x1FFF ? &cpuRAM[addr & 0x07FF] : nullptr;
 	}
 
-	return data;
+	(this->*mapCartridgePages)(first < 0x60 ? 0x60 : first);
+
+	// The zero page and stack must still be RAM, as the CPU bypasses the page table for them.
+	assert(pages[0x00].read == &cpuRAM[0x0000] && pages[0x01].read == &cpuRAM[0x0100]);
+	assert(pages[0x00].write == &cpuRAM[0x0000] && pages[0x01].write == &cpuRAM[0x0100]);
+}
+
+template <class MapperT>
+void Bus::mapPrgPages(u16 first)
+{
+	// Only PRG ROM is read directly, mapped in 8KB banks. Writes always
+	// go to the mapper, which may use them to switch banks.
+	for (u16 bank = first & 0xE0; bank < 0x100; bank += 0x20)
+	{
+		u8 *prg = cart->getPrgPointer<MapperT>(bank << 8, 0x2000);
+
+		// Most writes don't switch banks.
+		if (pages[bank].read == prg)
+			continue;
+
+		for (u16 i = 0; i < 0x20; i++)
+		{
+			pages[bank + i].read = prg != nullptr ? prg + (i << 8) : nullptr;
+			pages[bank + i].write = nullptr;
+		}
+	}
+}
+
+template <class MapperT>
+void Bus::specialise()
+{
+	mapDevice(0x4100, 0xFFFF, &Bus::readCartridge<MapperT>, &Bus::writeCartridge<MapperT>);
+	for (u16 addr = 0x4020; addr <= 0x40FF; addr++)
+		mapRegister(addr, &Bus::readCartridge<MapperT>, &Bus::writeCartridge<MapperT>);
+
+	mapCartridgePages = &Bus::mapPrgPages<MapperT>;
+	ppu.specialise<MapperT>();
+	cpu.specialise<MapperT>();
 }
 
 //----------------------//
 // System Interface		//
 //----------------------//
 
-void Bus::insertCartridge(const std::shared_ptr<Cartridge> &cartridge)
+void Bus::insertCartridge(Cartridge *cartridge)
 {
 	// Connect the cartridge to the interconnect and PPU buses.
 	this->cart = cartridge;
 	ppu.connectCartridge(cartridge);
+
+	// The mapper drives the IRQ line.
+	if (cart->getMapper() != nullptr)
+		cart->getMapper()->connectInterrupts(&interrupts);
+
+	// Pick the specialisation for the mapper, or the general one if
+	// there isn't one, e.g. because the cartridge failed to load.
+	switch (cart->getMapper() != nullptr ? cart->getMapperID() : 0xFF)
+	{
+#define MAPPER(id, MapperT) case id: specialise<MapperT>(); break;
+	OCRNES_MAPPER_TABLE(MAPPER)
+#undef MAPPER
+	default: specialise<Mapper>(); break;
+	}
+
+	// Code decoded from the previous cartridge is no longer valid.
+	cpu.invalidateBlockCache();
+	mapPages();
 }
 
 void Bus::reset()
 {
 	// Reset the Bus to a known state.
+	interrupts.reset();
 	cart->reset();
+	mapPages();
 	cpu.reset();
 	ppu.reset();
 
-	clockCounter = 0;
+	masterClock = 0;
+	cpuNextDue = 0;
 
 	dmaPage = 0x00;
 	dmaAddr = 0x00;
@@ -93,21 +253,23 @@ void Bus::clockCycle()
 	ppu.clockCycle();
 
     // CPU runs 3 times slower than PPU.
-	if (clockCounter % 3 == 0)
+	if (masterClock == cpuNextDue)
 	{
+		cpuNextDue += CPU_CLOCK_DIVIDER;
+
 		// DMA transfer in progress?
 		if (dmaInProgress)
 		{
 			// Wait for an even cycle before startig it.
 			if (dmaIdle)
 			{
-				if (clockCounter % 2 == 1)
+				if (masterClock & 1)
 					dmaIdle = false;
 			}
 			else
 			{
 				// Begin DMA.
-				if (clockCounter % 2 == 0)
+				if (!(masterClock & 1))
 					// Read from CPU bus on even cycles.
 					dmaData = cpuRead(dmaPage << 8 | dmaAddr);
 				else
@@ -135,21 +297,198 @@ void Bus::clockCycle()
 		}
 	}
 
-	// The PPU can emit an NMI on VBlank.
-	if (ppu.nmi)
+	masterClock++;
+}
+
+void Bus::runFrame()
+{
+	// The core is chosen once per frame, so neither pays for the other in its
+	// loop. The cycle-stepped core's accesses are only seen on their own
+	// cycles by running it ahead, so it always catches the PPU up.
+	if (cpuCore == CPUCore::CYCLE_STEPPED)
+		runFrameWith<CPU::CycleSteppedCore>(Timing::CATCH_UP);
+	else
+		runFrameWith<CPU::FastCore>(timing);
+}
+
+template <class Core>
+void Bus::runFrameWith(Timing frameTiming)
+{
+	scheduleEvents(frameTiming);
+
+	while (!ppu.frameComplete)
 	{
-		ppu.nmi = false;
-		cpu.nmi();
+		if (frameTiming == Timing::CATCH_UP)
+		{
+			// Nothing either can see changes before the next event, so the CPU
+			// can run ahead to it, and the PPU can then catch up. The CPU may
+			// schedule an earlier event itself, e.g. by starting DMA.
+			runCPUUntil<Core>(scheduler.next());
+			runPPUUntil(scheduler.next());
+		}
+		else
+		{
+			// Between events, only the PPU and CPU need to be clocked.
+			while (masterClock < scheduler.next())
+			{
+				ppu.clockCycle();
+
+				if (masterClock == cpuNextDue)
+				{
+					cpuNextDue += CPU_CLOCK_DIVIDER;
+					cpu.clockCycle();
+				}
+
+				masterClock++;
+			}
+		}
+
+		runEvents();
 	}
+}
+
+//--------------//
+// Events		//
+//--------------//
+
+void Bus::scheduleEvents(Timing frameTiming)
+{
+	scheduler.clear();
+
+	if (dmaInProgress)
+		scheduler.schedule(Scheduler::DMA, masterClock);
 
-    // Check for cartridge IRQ.
-	if (cart->getMapper()->irqState())
+	scheduler.schedule(Scheduler::FRAME_END, masterClock + ppu.cyclesUntilFrameEnd());
+
+	// The CPU can only run ahead of the PPU up to the cycles on which it may
+	// raise an interrupt. Register accesses are caught up to as they happen.
+	if (frameTiming == Timing::CATCH_UP)
 	{
-		cart->getMapper()->irqClear();
-		cpu.irq();
+		scheduler.schedule(Scheduler::VBLANK, masterClock + ppu.cyclesUntilVBlank());
+
+		if (cart->getMapper() != nullptr && cart->getMapper()->scanlineIRQ())
+			scheduler.schedule(Scheduler::SCANLINE, masterClock + ppu.cyclesUntilScanlineClock());
 	}
+}
+
+void Bus::runEvents()
+{
+	// Handlers may run the PPU, so events they schedule are left until the
+	// CPU has caught up. Events left after the frame ends are rescheduled
+	// with the next one.
+	u64 now = masterClock;
+	while (!ppu.frameComplete && scheduler.next() <= now)
+	{
+		u64 timestamp = scheduler.next();
+
+		switch (scheduler.pop())
+		{
+		case Scheduler::DMA:
+			// Otherwise, the transfer is clocked as normal until it completes,
+			// as the CPU is stalled meanwhile. If the frame ends first, it is
+			// rescheduled when the next frame is run.
+			if (!transferDMA())
+				while (dmaInProgress && !ppu.frameComplete)
+					clockCycle();
+			break;
+
+		case Scheduler::VBLANK:
+			// Run the PPU through the event's cycle, so the CPU sees any
+			// interrupt from its next instruction. It may have already been
+			// run past it, e.g. during DMA.
+			runPPUUntil(timestamp + 1);
+			scheduler.schedule(Scheduler::VBLANK, masterClock + ppu.cyclesUntilVBlank());
+			break;
 
-	clockCounter++;
+		case Scheduler::SCANLINE:
+			runPPUUntil(timestamp + 1);
+			scheduler.schedule(Scheduler::SCANLINE, masterClock + ppu.cyclesUntilScanlineClock());
+			break;
+
+		case Scheduler::FRAME_END:
+			// The frame may not have skipped the cycle it was predicted to.
+			if (!ppu.frameComplete)
+				scheduler.schedule(Scheduler::FRAME_END, masterClock + ppu.cyclesUntilFrameEnd());
+			break;
+
+		default:
+			break;
+		}
+	}
+}
+
+//------//
+// DMA  //
+//------//
+
+bool Bus::transferDMA()
+{
+	// Only RAM and ROM are read directly, and the transfer must not have started.
+	const u8 *source = pages[dmaPage].read;
+	if (source == nullptr || !dmaIdle)
+		return false;
+
+	// The transfer waits for an odd cycle, then reads on the even cycles
+	// and writes on the odd cycles after it, taking 513 or 514 CPU cycles.
+	u64 aligned = (cpuNextDue & 1) ? cpuNextDue : cpuNextDue + CPU_CLOCK_DIVIDER;
+	u64 lastWrite = aligned + 2 * CPU_CLOCK_DIVIDER * 256;
+
+	// The frame must end with the transfer part way, as it would byte by byte.
+	if (lastWrite >= masterClock + ppu.cyclesUntilFrameEnd())
+		return false;
+
+	// The PPU only reads OAM to evaluate sprites, so bytes written before it next
+	// does can be copied at once. After that, it must be caught up to each write.
+	u64 evaluation = masterClock + ppu.cyclesUntilSpriteEvaluation();
+
+	for (u16 i = 0; i < 256; i++)
+	{
+		u64 write = aligned + 2 * CPU_CLOCK_DIVIDER * (i + 1);
+		if (write >= evaluation)
+			runPPUUntil(write + 1);
+
+		ppu.publicOAM[i] = source[i];
+	}
+
+	dmaData = source[0xFF];
+	dmaAddr = 0x00;
+	dmaIdle = true;
+	dmaInProgress = false;
+
+	// The CPU continues on the cycle after the last write.
+	cpuNextDue = lastWrite + CPU_CLOCK_DIVIDER;
+
+	return true;
+}
+
+//--------------//
+// Catch-Up		//
+//--------------//
+
+template <class Core>
+void Bus::runCPUUntil(u64 timestamp)
+{
+	if (cpuNextDue >= timestamp)
+		return;
+
+	// The CPU's cycles before the timestamp.
+	u32 budget = (u32)((timestamp - cpuNextDue + CPU_CLOCK_DIVIDER - 1) / CPU_CLOCK_DIVIDER);
+
+	// New instructions start once the one in progress has finished.
+	cpuRunBase = cpuNextDue + CPU_CLOCK_DIVIDER * cpu.getCyclesLeft() - CPU_CLOCK_DIVIDER * cpu.executedCycles;
+	cpuRunning = true;
+	cpuStopped = false;
+
+	Core::run(cpu, budget);
+
+	u64 nextInstruction = cpuTimestamp();
+	cpuRunning = false;
+
+	// The CPU has had its cycles up to the end of the budget, or up to the
+	// instruction which started DMA, which takes the cycles after it. The
+	// rest of its last instruction is idled through as normal.
+	cpuNextDue = cpuStopped ? cpuStopTick + CPU_CLOCK_DIVIDER : cpuNextDue + CPU_CLOCK_DIVIDER * budget;
+	cpu.setCyclesLeft(nextInstruction > cpuNextDue ? (u8)((nextInstruction - cpuNextDue) / CPU_CLOCK_DIVIDER) : 0);
 }
 
 //--------------//
@@ -163,8 +502,9 @@ void Bus::writeSaveStateData(std::ofstream& state)
     // 4 bytes.
     state.write((char*)&controller[0], sizeof(u8) * 2);
     state.write((char*)&controllerStateCache[0], sizeof(u8) * 2);
-    // 4 bytes.
-    state.write((char*)&clockCounter, sizeof(u32) * 1);
+    // 16 bytes.
+    state.write((char*)&masterClock, sizeof(u64));
+    state.write((char*)&cpuNextDue, sizeof(u64));
     // 3 bytes.
     state.write((char*)&dmaPage, sizeof(u8));
     state.write((char*)&dmaAddr, sizeof(u8));
@@ -172,6 +512,8 @@ void Bus::writeSaveStateData(std::ofstream& state)
     // 2 bytes.
     state.write((char*)&dmaIdle, sizeof(bool));
     state.write((char*)&dmaInProgress, sizeof(bool));
+    // 3 bytes.
+    interrupts.writeSaveStateData(state);
 }
 
 void Bus::loadSaveStateData(std::ifstream& state)
@@ -181,8 +523,9 @@ void Bus::loadSaveStateData(std::ifstream& state)
     // 4 bytes.
     state.read((char*)&controller[0], sizeof(u8) * 2);
     state.read((char*)&controllerStateCache[0], sizeof(u8) * 2);
-    // 4 bytes.
-    state.read((char*)&clockCounter, sizeof(u32));
+    // 16 bytes.
+    state.read((char*)&masterClock, sizeof(u64));
+    state.read((char*)&cpuNextDue, sizeof(u64));
     // 3 bytes.
     state.read((char*)&dmaPage, sizeof(u8));
     state.read((char*)&dmaAddr, sizeof(u8));
@@ -190,4 +533,6 @@ void Bus::loadSaveStateData(std::ifstream& state)
     // 2 bytes.
     state.read((char*)&dmaIdle, sizeof(bool));
     state.read((char*)&dmaInProgress, sizeof(bool));
+    // 3 bytes.
+    interrupts.loadSaveStateData(state);
 }
@@ -87,17 +87,16 @@ bool Cartridge::load(const std::string& path)
 		// Load appropriate mapper
 		switch (mapperID)
 		{
-		case 0: mapper = std::make_shared<Mapper_000>(prgBanks, chrBanks); break;
-		case 1: mapper = std::make_shared<Mapper_001>(prgBanks, chrBanks); break;
-		case 2: mapper = std::make_shared<Mapper_002>(prgBanks, chrBanks); break;
-		case 3: mapper = std::make_shared<Mapper_003>(prgBanks, chrBanks); break;
-		case 4: mapper = std::make_shared<Mapper_004>(prgBanks, chrBanks); break;
-		case 66: mapper = std::make_shared<Mapper_066>(prgBanks, chrBanks); break;
-		default: mapper = std::make_shared<Mapper_000>(prgBanks, chrBanks); return false;
+#define MAPPER(id, MapperT) case id: mapper = std::make_unique<MapperT>(prgBanks, chrBanks); break;
+		OCRNES_MAPPER_TABLE(MAPPER)
+#undef MAPPER
+		default: mapper = std::make_unique<Mapper_000>(prgBanks, chrBanks); return false;
 		}
 
 		ifs.close();
 
+		decodeChr();
+
 		return true;
 	}
 	else
@@ -106,72 +105,18 @@ bool Cartridge::load(const std::string& path)
 
 Cartridge::~Cartridge() {}
 
-//------------------------------//
-// Interconnect Bus Linkage     //
-//------------------------------//
-
-bool Cartridge::cpuRead(u16 addr, u8& data)
+void Cartridge::decodeChr()
 {
-	u32 mappedAddr = 0;
-
-	if (mapper->cpuMapRead(addr, mappedAddr, data))
-	{
-		if (mappedAddr == 0xFFFFFFFF)
-			// Mapper has set the data value, e.g., cartridge RAM.
-			return true;
-		else
-			// Mapper has produced an offset into cartridge bank memory.
-			data = prgMemory[mappedAddr];
-
-		return true;
-	}
-	else
-		return false;
+	// 16 bytes a tile, for 8 rows.
+	chrRows.resize(chrMemory.size() / 2);
+	for (u32 offset = 0; offset + 16 <= chrMemory.size(); offset += 16)
+		for (u32 row = 0; row < 8; row++)
+			decodeChrRow(offset + row);
 }
 
-bool Cartridge::cpuWrite(u16 addr, u8 data)
-{
-	u32 mappedAddr = 0;
-
-	if (mapper->cpuMapWrite(addr, mappedAddr, data))
-	{
-		if (mappedAddr == 0xFFFFFFFF)
-			// Mapper has set the data value, e.g., cartridge RAM.
-			return true;
-		else
-			// Mapper has produced an offset into cartridge bank memory.
-			prgMemory[mappedAddr] = data;
-		return true;
-	}
-	else
-		return false;
-}
-
-bool Cartridge::ppuRead(u16 addr, u8& data)
-{
-	u32 mappedAddr = 0;
-
-	if (mapper->ppuMapRead(addr, mappedAddr))
-	{
-		data = chrMemory[mappedAddr];
-		return true;
-	}
-	else
-		return false;
-}
-
-bool Cartridge::ppuWrite(u16 addr, u8 data)
-{
-	u32 mappedAddr = 0;
-
-	if (mapper->ppuMapWrite(addr, mappedAddr))
-	{
-		chrMemory[mappedAddr] = data;
-		return true;
-	}
-	else
-		return false;
-}
+//------------------------------//
+// Interconnect Bus Linkage     //
+//------------------------------//
 
 void Cartridge::reset()
 {
@@ -184,23 +129,6 @@ void Cartridge::reset()
 // Getters      //
 //--------------//
 
-Mirror Cartridge::mirror()
-{
-	Mirror m = mapper->mirror();
-
-	if (m == Mirror::HARDWARE)
-		// Mirror configuration is harware-defined.
-		return hwMirror;
-	else
-		// Mirror configuration can be set dynamically by the mapper.
-		return m;
-}
-
-std::shared_ptr<Mapper> Cartridge::getMapper()
-{
-	return mapper;
-}
-
 u8 Cartridge::getMapperID()
 {
 	return mapperID;
@@ -247,5 +175,6 @@ void Cartridge::loadSaveStateData(std::ifstream& state)
      state.read((char*)&vecLength, sizeof(u32));
      chrMemory.resize(vecLength);
      state.read((char*)&(chrMemory.data()[0]), sizeof(u8) * vecLength);
+     decodeChr();
      mapper->loadSaveStateData(state);
 }
\ No newline at end of file
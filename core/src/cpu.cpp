@@ -20,269 +20,93 @@
 
 #include <cpu.h>
 #include <bus.h>
-
-CPU::CPU()
-{
-	using x = CPU;
-	instructions = {
-		{&x::BRK, &x::IMM, 7},
-		{&x::ORA, &x::IZX, 6},
-		{&x::XXX, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 8},
-		{&x::NOP, &x::IMP, 3},
-		{&x::ORA, &x::ZP0, 3},
-		{&x::ASL, &x::ZP0, 5},
-		{&x::XXX, &x::IMP, 5},
-		{&x::PHP, &x::IMP, 3},
-		{&x::ORA, &x::IMM, 2},
-		{&x::ASL, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 2},
-		{&x::NOP, &x::IMP, 4},
-		{&x::ORA, &x::ABS, 4},
-		{&x::ASL, &x::ABS, 6},
-		{&x::XXX, &x::IMP, 6},
-		{&x::BPL, &x::REL, 2},
-		{&x::ORA, &x::IZY, 5},
-		{&x::XXX, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 8},
-		{&x::NOP, &x::IMP, 4},
-		{&x::ORA, &x::ZPX, 4},
-		{&x::ASL, &x::ZPX, 6},
-		{&x::XXX, &x::IMP, 6},
-		{&x::CLC, &x::IMP, 2},
-		{&x::ORA, &x::ABY, 4},
-		{&x::NOP, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 7},
-		{&x::NOP, &x::IMP, 4},
-		{&x::ORA, &x::ABX, 4},
-		{&x::ASL, &x::ABX, 7},
-		{&x::XXX, &x::IMP, 7},
-		{&x::JSR, &x::ABS, 6},
-		{&x::AND, &x::IZX, 6},
-		{&x::XXX, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 8},
-		{&x::BIT, &x::ZP0, 3},
-		{&x::AND, &x::ZP0, 3},
-		{&x::ROL, &x::ZP0, 5},
-		{&x::XXX, &x::IMP, 5},
-		{&x::PLP, &x::IMP, 4},
-		{&x::AND, &x::IMM, 2},
-		{&x::ROL, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 2},
-		{&x::BIT, &x::ABS, 4},
-		{&x::AND, &x::ABS, 4},
-		{&x::ROL, &x::ABS, 6},
-		{&x::XXX, &x::IMP, 6},
-		{&x::BMI, &x::REL, 2},
-		{&x::AND, &x::IZY, 5},
-		{&x::XXX, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 8},
-		{&x::NOP, &x::IMP, 4},
-		{&x::AND, &x::ZPX, 4},
-		{&x::ROL, &x::ZPX, 6},
-		{&x::XXX, &x::IMP, 6},
-		{&x::SEC, &x::IMP, 2},
-		{&x::AND, &x::ABY, 4},
-		{&x::NOP, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 7},
-		{&x::NOP, &x::IMP, 4},
-		{&x::AND, &x::ABX, 4},
-		{&x::ROL, &x::ABX, 7},
-		{&x::XXX, &x::IMP, 7},
-		{&x::RTI, &x::IMP, 6},
-		{&x::EOR, &x::IZX, 6},
-		{&x::XXX, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 8},
-		{&x::NOP, &x::IMP, 3},
-		{&x::EOR, &x::ZP0, 3},
-		{&x::LSR, &x::ZP0, 5},
-		{&x::XXX, &x::IMP, 5},
-		{&x::PHA, &x::IMP, 3},
-		{&x::EOR, &x::IMM, 2},
-		{&x::LSR, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 2},
-		{&x::JMP, &x::ABS, 3},
-		{&x::EOR, &x::ABS, 4},
-		{&x::LSR, &x::ABS, 6},
-		{&x::XXX, &x::IMP, 6},
-		{&x::BVC, &x::REL, 2},
-		{&x::EOR, &x::IZY, 5},
-		{&x::XXX, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 8},
-		{&x::NOP, &x::IMP, 4},
-		{&x::EOR, &x::ZPX, 4},
-		{&x::LSR, &x::ZPX, 6},
-		{&x::XXX, &x::IMP, 6},
-		{&x::CLI, &x::IMP, 2},
-		{&x::EOR, &x::ABY, 4},
-		{&x::NOP, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 7},
-		{&x::NOP, &x::IMP, 4},
-		{&x::EOR, &x::ABX, 4},
-		{&x::LSR, &x::ABX, 7},
-		{&x::XXX, &x::IMP, 7},
-		{&x::RTS, &x::IMP, 6},
-		{&x::XXX, &x::IMP, 2},
-		{&x::ADC, &x::IZX, 6},
-		{&x::XXX, &x::IMP, 8},
-		{&x::NOP, &x::IMP, 3},
-		{&x::ADC, &x::ZP0, 3},
-		{&x::ROR, &x::ZP0, 5},
-		{&x::XXX, &x::IMP, 5},
-		{&x::PLA, &x::IMP, 4},
-		{&x::ADC, &x::IMM, 2},
-		{&x::ROR, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 2},
-		{&x::JMP, &x::IND, 5},
-		{&x::ADC, &x::ABS, 4},
-		{&x::ROR, &x::ABS, 6},
-		{&x::XXX, &x::IMP, 6},
-		{&x::BVS, &x::REL, 2},
-		{&x::ADC, &x::IZY, 5},
-		{&x::XXX, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 8},
-		{&x::NOP, &x::IMP, 4},
-		{&x::ADC, &x::ZPX, 4},
-		{&x::ROR, &x::ZPX, 6},
-		{&x::XXX, &x::IMP, 6},
-		{&x::SEI, &x::IMP, 2},
-		{&x::ADC, &x::ABY, 4},
-		{&x::NOP, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 7},
-		{&x::NOP, &x::IMP, 4},
-		{&x::ADC, &x::ABX, 4},
-		{&x::ROR, &x::ABX, 7},
-		{&x::XXX, &x::IMP, 7},
-		{&x::NOP, &x::IMP, 2},
-		{&x::STA, &x::IZX, 6},
-		{&x::NOP, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 6},
-		{&x::STY, &x::ZP0, 3},
-		{&x::STA, &x::ZP0, 3},
-		{&x::STX, &x::ZP0, 3},
-		{&x::XXX, &x::IMP, 3},
-		{&x::DEY, &x::IMP, 2},
-		{&x::NOP, &x::IMP, 2},
-		{&x::TXA, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 2},
-		{&x::STY, &x::ABS, 4},
-		{&x::STA, &x::ABS, 4},
-		{&x::STX, &x::ABS, 4},
-		{&x::XXX, &x::IMP, 4},
-		{&x::BCC, &x::REL, 2},
-		{&x::STA, &x::IZY, 6},
-		{&x::XXX, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 6},
-		{&x::STY, &x::ZPX, 4},
-		{&x::STA, &x::ZPX, 4},
-		{&x::STX, &x::ZPY, 4},
-		{&x::XXX, &x::IMP, 4},
-		{&x::TYA, &x::IMP, 2},
-		{&x::STA, &x::ABY, 5},
-		{&x::TXS, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 5},
-		{&x::NOP, &x::IMP, 5},
-		{&x::STA, &x::ABX, 5},
-		{&x::XXX, &x::IMP, 5},
-		{&x::XXX, &x::IMP, 5},
-		{&x::LDY, &x::IMM, 2},
-		{&x::LDA, &x::IZX, 6},
-		{&x::LDX, &x::IMM, 2},
-		{&x::XXX, &x::IMP, 6},
-		{&x::LDY, &x::ZP0, 3},
-		{&x::LDA, &x::ZP0, 3},
-		{&x::LDX, &x::ZP0, 3},
-		{&x::XXX, &x::IMP, 3},
-		{&x::TAY, &x::IMP, 2},
-		{&x::LDA, &x::IMM, 2},
-		{&x::TAX, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 2},
-		{&x::LDY, &x::ABS, 4},
-		{&x::LDA, &x::ABS, 4},
-		{&x::LDX, &x::ABS, 4},
-		{&x::XXX, &x::IMP, 4},
-		{&x::BCS, &x::REL, 2},
-		{&x::LDA, &x::IZY, 5},
-		{&x::XXX, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 5},
-		{&x::LDY, &x::ZPX, 4},
-		{&x::LDA, &x::ZPX, 4},
-		{&x::LDX, &x::ZPY, 4},
-		{&x::XXX, &x::IMP, 4},
-		{&x::CLV, &x::IMP, 2},
-		{&x::LDA, &x::ABY, 4},
-		{&x::TSX, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 4},
-		{&x::LDY, &x::ABX, 4},
-		{&x::LDA, &x::ABX, 4},
-		{&x::LDX, &x::ABY, 4},
-		{&x::XXX, &x::IMP, 4},
-		{&x::CPY, &x::IMM, 2},
-		{&x::CMP, &x::IZX, 6},
-		{&x::NOP, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 8},
-		{&x::CPY, &x::ZP0, 3},
-		{&x::CMP, &x::ZP0, 3},
-		{&x::DEC, &x::ZP0, 5},
-		{&x::XXX, &x::IMP, 5},
-		{&x::INY, &x::IMP, 2},
-		{&x::CMP, &x::IMM, 2},
-		{&x::DEX, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 2},
-		{&x::CPY, &x::ABS, 4},
-		{&x::CMP, &x::ABS, 4},
-		{&x::DEC, &x::ABS, 6},
-		{&x::XXX, &x::IMP, 6},
-		{&x::BNE, &x::REL, 2},
-		{&x::CMP, &x::IZY, 5},
-		{&x::XXX, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 8},
-		{&x::NOP, &x::IMP, 4},
-		{&x::CMP, &x::ZPX, 4},
-		{&x::DEC, &x::ZPX, 6},
-		{&x::XXX, &x::IMP, 6},
-		{&x::CLD, &x::IMP, 2},
-		{&x::CMP, &x::ABY, 4},
-		{&x::NOP, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 7},
-		{&x::NOP, &x::IMP, 4},
-		{&x::CMP, &x::ABX, 4},
-		{&x::DEC, &x::ABX, 7},
-		{&x::XXX, &x::IMP, 7},
-		{&x::CPX, &x::IMM, 2},
-		{&x::SBC, &x::IZX, 6},
-		{&x::NOP, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 8},
-		{&x::CPX, &x::ZP0, 3},
-		{&x::SBC, &x::ZP0, 3},
-		{&x::INC, &x::ZP0, 5},
-		{&x::XXX, &x::IMP, 5},
-		{&x::INX, &x::IMP, 2},
-		{&x::SBC, &x::IMM, 2},
-		{&x::NOP, &x::IMP, 2},
-		{&x::SBC, &x::IMP, 2},
-		{&x::CPX, &x::ABS, 4},
-		{&x::SBC, &x::ABS, 4},
-		{&x::INC, &x::ABS, 6},
-		{&x::XXX, &x::IMP, 6},
-		{&x::BEQ, &x::REL, 2},
-		{&x::SBC, &x::IZY, 5},
-		{&x::XXX, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 8},
-		{&x::NOP, &x::IMP, 4},
-		{&x::SBC, &x::ZPX, 4},
-		{&x::INC, &x::ZPX, 6},
-		{&x::XXX, &x::IMP, 6},
-		{&x::SED, &x::IMP, 2},
-		{&x::SBC, &x::ABY, 4},
-		{&x::NOP, &x::IMP, 2},
-		{&x::XXX, &x::IMP, 7},
-		{&x::NOP, &x::IMP, 4},
-		{&x::SBC, &x::ABX, 4},
-		{&x::INC, &x::ABX, 7},
-		{&x::XXX, &x::IMP, 7},
-	};
-}
+#include <opcodes.h>
+
+// Language Headers.
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+
+// Whether tracing is built in. If not, no instruction is ever recorded.
+static constexpr bool TRACING = decltype(CPU::trace)::ENABLED;
+
+// Every entry is resolved at compile time to a handler specialised for
+// the opcode's addressing mode and page-crossing behaviour.
+const CPU::Instruction CPU::instructions[256] = {
+#define OP(opcode, impl, addrmode, cycles, pagecross) \
+	{ \
+		&CPU::execute<AddrMode::addrmode, &CPU::impl<AddrMode::addrmode>, pagecross>, \
+		&CPU::executeDecoded<AddrMode::addrmode, &CPU::impl<AddrMode::addrmode>, pagecross>, \
+		cycles \
+	},
+	OCRNES_OPCODE_TABLE(OP)
+#undef OP
+};
+
+const JIT::InstructionThunk CPU::compiledInstructions[256] = {
+#define OP(opcode, impl, addrmode, cycles, pagecross) \
+	&CPU::executeCompiled<AddrMode::addrmode, &CPU::impl<AddrMode::addrmode>, pagecross, opcode, cycles>,
+	OCRNES_OPCODE_TABLE(OP)
+#undef OP
+};
+
+// How each instruction accesses the memory at its effective address, for the
+// cycle-stepped core. Implied, immediate and relative operands never do.
+static constexpr CPU::Access ACCESS_ADC = CPU::Access::READ, ACCESS_AND = CPU::Access::READ;
+static constexpr CPU::Access ACCESS_BIT = CPU::Access::READ, ACCESS_CMP = CPU::Access::READ;
+static constexpr CPU::Access ACCESS_CPX = CPU::Access::READ, ACCESS_CPY = CPU::Access::READ;
+static constexpr CPU::Access ACCESS_EOR = CPU::Access::READ, ACCESS_LDA = CPU::Access::READ;
+static constexpr CPU::Access ACCESS_LDX = CPU::Access::READ, ACCESS_LDY = CPU::Access::READ;
+static constexpr CPU::Access ACCESS_ORA = CPU::Access::READ, ACCESS_SBC = CPU::Access::READ;
+static constexpr CPU::Access ACCESS_STA = CPU::Access::WRITE, ACCESS_STX = CPU::Access::WRITE;
+static constexpr CPU::Access ACCESS_STY = CPU::Access::WRITE;
+static constexpr CPU::Access ACCESS_ASL = CPU::Access::MODIFY, ACCESS_DEC = CPU::Access::MODIFY;
+static constexpr CPU::Access ACCESS_INC = CPU::Access::MODIFY, ACCESS_LSR = CPU::Access::MODIFY;
+static constexpr CPU::Access ACCESS_ROL = CPU::Access::MODIFY, ACCESS_ROR = CPU::Access::MODIFY;
+
+// Branches, jumps, stack operations and register operations.
+static constexpr CPU::Access ACCESS_BCC = CPU::Access::NONE, ACCESS_BCS = CPU::Access::NONE;
+static constexpr CPU::Access ACCESS_BEQ = CPU::Access::NONE, ACCESS_BMI = CPU::Access::NONE;
+static constexpr CPU::Access ACCESS_BNE = CPU::Access::NONE, ACCESS_BPL = CPU::Access::NONE;
+static constexpr CPU::Access ACCESS_BVC = CPU::Access::NONE, ACCESS_BVS = CPU::Access::NONE;
+static constexpr CPU::Access ACCESS_BRK = CPU::Access::NONE, ACCESS_JMP = CPU::Access::NONE;
+static constexpr CPU::Access ACCESS_JSR = CPU::Access::NONE, ACCESS_RTI = CPU::Access::NONE;
+static constexpr CPU::Access ACCESS_RTS = CPU::Access::NONE, ACCESS_PHA = CPU::Access::NONE;
+static constexpr CPU::Access ACCESS_PHP = CPU::Access::NONE, ACCESS_PLA = CPU::Access::NONE;
+static constexpr CPU::Access ACCESS_PLP = CPU::Access::NONE, ACCESS_CLC = CPU::Access::NONE;
+static constexpr CPU::Access ACCESS_CLD = CPU::Access::NONE, ACCESS_CLI = CPU::Access::NONE;
+static constexpr CPU::Access ACCESS_CLV = CPU::Access::NONE, ACCESS_SEC = CPU::Access::NONE;
+static constexpr CPU::Access ACCESS_SED = CPU::Access::NONE, ACCESS_SEI = CPU::Access::NONE;
+static constexpr CPU::Access ACCESS_DEX = CPU::Access::NONE, ACCESS_DEY = CPU::Access::NONE;
+static constexpr CPU::Access ACCESS_INX = CPU::Access::NONE, ACCESS_INY = CPU::Access::NONE;
+static constexpr CPU::Access ACCESS_TAX = CPU::Access::NONE, ACCESS_TAY = CPU::Access::NONE;
+static constexpr CPU::Access ACCESS_TSX = CPU::Access::NONE, ACCESS_TXA = CPU::Access::NONE;
+static constexpr CPU::Access ACCESS_TXS = CPU::Access::NONE, ACCESS_TYA = CPU::Access::NONE;
+static constexpr CPU::Access ACCESS_NOP = CPU::Access::NONE, ACCESS_XXX = CPU::Access::NONE;
+
+u8 (CPU::*const CPU::cycleSteppedInstructions[256])() = {
+#define OP(opcode, impl, addrmode, cycles, pagecross) \
+	&CPU::executeCycleStepped<AddrMode::addrmode, &CPU::impl<AddrMode::addrmode>, ACCESS_##impl, pagecross, opcode, cycles>,
+	OCRNES_OPCODE_TABLE(OP)
+#undef OP
+};
+
+// Countdown loops, polling loops and copy loops account for much of the time
+// spent by games, so their instruction pairs are run by a single handler.
+const CPU::FusedInstruction CPU::fusedInstructions[] = {
+	{ 0x00, 0x00, nullptr },
+	{ 0xCA, 0xD0, &CPU::executeFused<0xCA, 0xD0> },	// DEX, BNE
+	{ 0x88, 0xD0, &CPU::executeFused<0x88, 0xD0> },	// DEY, BNE
+	{ 0xE8, 0xD0, &CPU::executeFused<0xE8, 0xD0> },	// INX, BNE
+	{ 0xC8, 0xD0, &CPU::executeFused<0xC8, 0xD0> },	// INY, BNE
+	{ 0xCA, 0x10, &CPU::executeFused<0xCA, 0x10> },	// DEX, BPL
+	{ 0x88, 0x10, &CPU::executeFused<0x88, 0x10> },	// DEY, BPL
+	{ 0xE6, 0xD0, &CPU::executeFused<0xE6, 0xD0> },	// INC zp, BNE
+	{ 0xC6, 0xD0, &CPU::executeFused<0xC6, 0xD0> },	// DEC zp, BNE
+	{ 0xA5, 0xC9, &CPU::executeFused<0xA5, 0xC9> },	// LDA zp, CMP #imm
+	{ 0xBD, 0x9D, &CPU::executeFused<0xBD, 0x9D> },	// LDA abs,X, STA abs,X
+	{ 0xB9, 0x99, &CPU::executeFused<0xB9, 0x99> },	// LDA abs,Y, STA abs,Y
+};
 
 //--------------//
 // Execution	//
@@ -299,7 +123,7 @@ void CPU::reset()
 	x = 0;
 	y = 0;
 	sp = 0xFD;
-	status = 0x00;
+	setStatus(0x00);
 	setFlag(U, true);
 
 	// Reset emulation variables.
@@ -309,6 +133,17 @@ void CPU::reset()
 
 	// A CPU reset takes 8 cycles.
 	instrCycles = 8;
+	totalCycles = 0;
+
+	// The mapper has also been reset, so decoded code may be stale.
+	invalidateBlockCache();
+}
+
+void CPU::invalidateBlockCache()
+{
+	blockCache.invalidate();
+	block = nullptr;
+	idleSnapshot.valid = false;
 }
 
 void CPU::irq()
@@ -317,16 +152,16 @@ void CPU::irq()
 	if (getFlag(I) == 0)
 	{
 		// Push PC to the stack.
-		write(0x0100 + sp, (pc >> 8) & 0x00FF);
+		writeRAM(0x0100 + sp, (pc >> 8) & 0x00FF);
 		sp--;
-		write(0x0100 + sp, pc & 0x00FF);
+		writeRAM(0x0100 + sp, pc & 0x00FF);
 		sp--;
 
 		// Push status register to the stack.
 		setFlag(B, 0);
 		setFlag(U, 1);
 		setFlag(I, 1);
-		write(0x0100 + sp, status);
+		writeRAM(0x0100 + sp, getStatus());
 		sp--;
 
 		// Read new PC from 0xFFFE.
@@ -341,9 +176,9 @@ void CPU::irq()
 void CPU::nmi()
 {
 	// Push PC to the stack.
-	write(0x0100 + sp, (pc >> 8) & 0x00FF);
+	writeRAM(0x0100 + sp, (pc >> 8) & 0x00FF);
 	sp--;
-	write(0x0100 + sp, pc & 0x00FF);
+	writeRAM(0x0100 + sp, pc & 0x00FF);
 	sp--;
 
 	// Push status register to the stack, with
@@ -351,7 +186,7 @@ void CPU::nmi()
 	setFlag(B, 0);
 	setFlag(U, 1);
 	setFlag(I, 1);
-	write(0x0100 + sp, status);
+	writeRAM(0x0100 + sp, getStatus());
 	sp--;
 
 	// Read new PC from 0xFFFA.
@@ -368,37 +203,539 @@ void CPU::clockCycle()
 	// its first cycle, rather than as multiple microcode operations
 	// over multiple cycles. This may reduce compatibility, but timing
 	// is kept correct by idling for the remaining number of cycles.
+	// Only this cycle may be run, so one instruction is stepped at a
+	// time, never a fused pair or the skipped iterations of an idle loop.
 	if (instrCycles == 0)
+		step(1);
+
+	// Decrement the remaining cycles for this instruction.
+	instrCycles--;
+	totalCycles++;
+}
+
+u32 CPU::runFor(u32 budget)
+{
+	// Finish the instruction (or interrupt) already in progress.
+	u32 used = instrCycles;
+	instrCycles = 0;
+
+	// The budget may be cut short while running.
+	runBudget = budget;
+
+	// Hot blocks can be run as native code.
+	if (dispatch == Dispatch::JIT)
+		used = runCompiled(used);
+
+	// Whole instructions can then be executed back to back, as the
+	// idle cycles between them no longer need to be stepped through.
+	while (used < runBudget)
 	{
-		// Read the opcode of the next instruction.
-		curOpcode = read(pc);
-		pc++;
+		used += step(runBudget - used < 0xFF ? runBudget - used : 0xFF);
+		instrCycles = 0;
+	}
 
-		// Unused flag is always set.
-		setFlag(U, 1);
+	totalCycles += used;
+	return used;
+}
+
+u32 CPU::runUntil(u64 timestamp)
+{
+	if (totalCycles >= timestamp)
+		return 0;
+
+	return runFor(timestamp - totalCycles);
+}
 
+u8 CPU::step(u8 limit)
+{
+	// The interrupt lines are sampled before each instruction.
+	if (bus->interrupts.active() && serviceInterrupt())
+	{
+		executedCycles += instrCycles;
+		return instrCycles;
+	}
+
+	if (dispatch == Dispatch::CACHED || dispatch == Dispatch::JIT)
+	{
+		// Continue through the current block if the PC hasn't left it,
+		// otherwise find the block starting at the PC.
+		if (block == nullptr || blockIndex >= block->count || block->entries[blockIndex].pc != pc)
+		{
+			block = blockCache.lookup(pc);
+			blockIndex = 0;
+		}
+
+		// Code which can't be cached falls through to be decoded as normal.
+		if (block != nullptr)
+		{
+			// Idle loops can be skipped from their first instruction.
+			if (blockIndex == 0 && block->idle != BlockCache::NOT_IDLE)
+			{
+				u8 skipped = skipIdle(*block, limit);
+				if (skipped > 0)
+				{
+					instrCycles = skipped;
+					executedCycles += skipped;
+					return instrCycles;
+				}
+			}
+
+			// Fused pairs are run by their own handler.
+			const BlockCache::Entry& entry = block->entries[blockIndex];
+			if (entry.fused != 0)
+			{
+				instrCycles = (this->*fusedInstructions[entry.fused].execute)(&entry, limit);
+				return instrCycles;
+			}
+
+			if constexpr (TRACING)
+				traceInstruction(pc);
+
+			blockIndex++;
+			curOpcode = entry.opcode;
+			pc += entry.length;
+
+			// Unused flag is always set.
+			setFlag(U, 1);
+
+			instrCycles = instructions[curOpcode].cycles;
+			u8 extra = (this->*instructions[curOpcode].executeDecoded)(entry.operand);
+			instrCycles += extra;
+
+			// Unused flag is always set.
+			setFlag(U, 1);
+
+			if (pairProfiling)
+				profilePair(curOpcode);
+
+			stepCount++;
+			stepCycles += instrCycles;
+			executedCycles += instrCycles;
+			return instrCycles;
+		}
+	}
+
+	if constexpr (TRACING)
+		traceInstruction(pc);
+
+	// Read the opcode of the next instruction.
+	curOpcode = read(pc);
+	pc++;
+
+	// Unused flag is always set.
+	setFlag(U, 1);
+
+	if (dispatch == Dispatch::SWITCH)
+	{
+		// The switch sets the base number of cycles itself.
+		u8 extra = executeSwitch();
+		instrCycles += extra;
+	}
+	else
+	{
 		// Set the remaining cycles to the instruction's
 		// base number of cycles.
 		instrCycles = instructions[curOpcode].cycles;
 
-		// The addressing mode and instruction functions
-		// both return u8's which can be logiclly ANDed together
-		// to give the number of extra cycles needed, if any.
+		// Fetch data and execute the instruction, then update the
+		// remaining cycles with the extra cycles needed.
+		u8 extra = (this->*instructions[curOpcode].execute)();
+		instrCycles += extra;
+	}
 
-		// Fetch data.
-		u8 extra1 = (this->*instructions[curOpcode].addrmode)();
-		// Execute the instruction.
-		u8 extra2 = (this->*instructions[curOpcode].impl)();
+	// Unused flag is always set.
+	setFlag(U, 1);
 
-		// Update the remaining cycles with the extra cycles needed.
-		instrCycles += (extra1 & extra2);
+	if (pairProfiling)
+		profilePair(curOpcode);
 
-		// Unused flag is always set.
-		setFlag(U, 1);
+	stepCount++;
+	stepCycles += instrCycles;
+	executedCycles += instrCycles;
+	return instrCycles;
+}
+
+bool CPU::serviceInterrupt()
+{
+	InterruptLines& lines = bus->interrupts;
+
+	// NMI takes priority, and is serviced once per rising edge.
+	if (lines.nmiPending)
+	{
+		lines.nmiPending = false;
+		nmi();
+		return true;
 	}
 
-	// Decrement the remaining cycles for this instruction.
-	instrCycles--;
+	// IRQ is serviced for as long as the line is held.
+	if (lines.irq != 0 && getFlag(I) == 0)
+	{
+		irq();
+		return true;
+	}
+
+	return false;
+}
+
+u32 CPU::runCycleStepped(u32 budget)
+{
+	// As runFor(), finishing the instruction already in progress first.
+	u32 used = instrCycles;
+	instrCycles = 0;
+
+	runBudget = budget;
+
+	while (used < runBudget)
+	{
+		used += stepCycleStepped();
+		instrCycles = 0;
+	}
+
+	totalCycles += used;
+	return used;
+}
+
+u8 CPU::stepCycleStepped()
+{
+	// Interrupts only touch the stack and vectors, so are run at once.
+	if (bus->interrupts.active() && serviceInterrupt())
+	{
+		executedCycles += instrCycles;
+		return instrCycles;
+	}
+
+	if constexpr (TRACING)
+		traceInstruction(pc);
+
+	instrStart = executedCycles;
+
+	curOpcode = read(pc);
+	pc++;
+
+	// Unused flag is always set.
+	setFlag(U, 1);
+
+	instrCycles = (this->*cycleSteppedInstructions[curOpcode])();
+
+	// Unused flag is always set.
+	setFlag(U, 1);
+
+	if (pairProfiling)
+		profilePair(curOpcode);
+
+	// The instruction may have left the counter on its last access.
+	stepCount++;
+	stepCycles += instrCycles;
+	executedCycles = instrStart + instrCycles;
+	return instrCycles;
+}
+
+u8 CPU::skipIdle(const BlockCache::Block& b, u8 limit)
+{
+	// The loop is only skipped once a whole iteration has been seen to run
+	// uninterrupted and leave the registers unchanged. As the loop makes no
+	// writes and its reads are stable until the next event, every following
+	// iteration until then must do the same.
+	bool verified = idleSnapshot.valid && idleSnapshot.pc == pc
+		&& stepCount - idleSnapshot.steps == b.count
+		&& idleSnapshot.a == a && idleSnapshot.x == x && idleSnapshot.y == y
+		&& idleSnapshot.sp == sp && idleSnapshot.status == status && idleSnapshot.nz == nz;
+
+	if (!verified)
+	{
+		idleSnapshot.valid = true;
+		idleSnapshot.pc = pc;
+		idleSnapshot.a = a;
+		idleSnapshot.x = x;
+		idleSnapshot.y = y;
+		idleSnapshot.sp = sp;
+		idleSnapshot.status = status;
+		idleSnapshot.nz = nz;
+		idleSnapshot.steps = stepCount;
+		idleSnapshot.cycles = stepCycles;
+		return 0;
+	}
+
+	// Every iteration takes the same number of cycles.
+	u32 length = stepCycles - idleSnapshot.cycles;
+
+	// The PPU may be behind the CPU, so is brought up to date to see what
+	// the loop would next see.
+	bus->syncPPU();
+
+	// The CPU runs once every 3 PPU cycles. Leave a cycle spare, so the
+	// CPU is back to executing the loop before the event happens.
+	u32 available = bus->ppu.cyclesUntilEvent(b.idle == BlockCache::IDLE_POLLS_STATUS, getFlag(I) == 0) / 3;
+	available = available > 0 ? available - 1 : 0;
+	if (available > limit)
+		available = limit;
+
+	// Skipping is equivalent to running the iterations, so the snapshot
+	// stays valid and the next iteration can also be skipped.
+	return (available / length) * length;
+}
+
+u32 CPU::runCompiled(u32 used)
+{
+	while (used < runBudget)
+	{
+		// Compiled blocks run without sampling the interrupt lines,
+		// so they are sampled before entering each one.
+		if (bus->interrupts.active() && serviceInterrupt())
+		{
+			used += instrCycles;
+			executedCycles += instrCycles;
+			instrCycles = 0;
+			continue;
+		}
+
+		// The lookup may re-decode the block being stepped through.
+		block = nullptr;
+		BlockCache::Block *b = blockCache.lookup(pc);
+
+		if (b == nullptr)
+		{
+			// The code can't be cached, so interpret it.
+			used += step(runBudget - used < 0xFF ? runBudget - used : 0xFF);
+			instrCycles = 0;
+			continue;
+		}
+
+		// Compile the block once it is hot. If the code buffer is full, all compiled
+		// code is discarded, which is cheap as hot blocks are soon recompiled.
+		if (b->compiled == nullptr && ++b->executions == JIT::COMPILE_THRESHOLD)
+		{
+			b->compiled = (void*)jit.compile(*b, compiledContext());
+
+			if (b->compiled == nullptr && jit.enabled())
+			{
+				blockCache.discardCompiled();
+				jit.reset();
+				b->compiled = (void*)jit.compile(*b, compiledContext());
+			}
+		}
+
+		// Idle loops are skipped rather than run.
+		if (b->idle != BlockCache::NOT_IDLE)
+		{
+			u8 skipped = skipIdle(*b, runBudget - used < 0xFF ? runBudget - used : 0xFF);
+			if (skipped > 0)
+			{
+				used += skipped;
+				executedCycles += skipped;
+				continue;
+			}
+		}
+
+		// Compiled code can't be run if the JIT failed after compiling it.
+		if (b->compiled != nullptr && jit.enabled())
+		{
+			exitCompiled = false;
+			used += ((JIT::CompiledBlock)b->compiled)(this, runBudget - used);
+			instrCycles = 0;
+		}
+		else
+		{
+			// Interpret the block until it is left.
+			block = b;
+			blockIndex = 0;
+
+			do
+			{
+				used += step(runBudget - used < 0xFF ? runBudget - used : 0xFF);
+				instrCycles = 0;
+			}
+			while (used < runBudget && block == b && blockIndex < b->count && b->entries[blockIndex].pc == pc);
+		}
+	}
+
+	// The block being stepped through may have been left part way.
+	block = nullptr;
+
+	return used;
+}
+
+u8 CPU::executeSwitch()
+{
+	// Each case sets the base cycles, then runs the addressing mode and
+	// the instruction in order. Both are direct calls in this translation
+	// unit, so the compiler is free to inline them into the case.
+	u8 extra = 0;
+
+	switch (curOpcode)
+	{
+#define OP(opcode, impl, addrmode, cycles, pagecross) \
+	case opcode: \
+		instrCycles = cycles; \
+		extra = execute<AddrMode::addrmode, &CPU::impl<AddrMode::addrmode>, pagecross>(); \
+		break;
+
+		OCRNES_OPCODE_TABLE(OP)
+#undef OP
+	}
+
+	return extra;
+}
+
+//----------------------//
+// Superinstructions	//
+//----------------------//
+
+u8 CPU::findFused(const BlockCache::Entry& first, const BlockCache::Entry& second)
+{
+	// Both must touch only memory without side effects, so nothing but the
+	// pair itself can change what the second instruction sees. Indexed stores
+	// must stay in system RAM for any index, while indexed loads may also read
+	// PRG ROM, so copies from ROM to RAM are fused too.
+	auto direct = [](const BlockCache::Entry& e)
+	{
+		switch (e.opcode)
+		{
+		case 0xBD: case 0xB9:	// LDA abs,X and abs,Y
+			return e.operand + 0xFF <= 0x1FFF || e.operand >= 0x8000;
+		case 0x9D: case 0x99:	// STA abs,X and abs,Y
+			return e.operand + 0xFF <= 0x1FFF;
+		default:
+			return true;
+		}
+	};
+
+	if (!direct(first) || !direct(second))
+		return 0;
+
+	for (u8 i = 1; i < sizeof(fusedInstructions) / sizeof(fusedInstructions[0]); i++)
+		if (fusedInstructions[i].first == first.opcode && fusedInstructions[i].second == second.opcode)
+			return i;
+
+	return 0;
+}
+
+//------------------//
+// Pair Profiling	//
+//------------------//
+
+void CPU::setPairProfiling(bool enabled)
+{
+	pairProfiling = enabled;
+
+	if (enabled)
+		pairCounts.assign(0x10000, 0);
+
+	// Translated instructions aren't profiled, so compiled code must be recompiled.
+	blockCache.discardCompiled();
+	jit.reset();
+}
+
+std::vector<CPU::PairCount> CPU::getHottestPairs(size_t n)
+{
+	std::vector<PairCount> pairs;
+
+	for (u32 i = 0; i < pairCounts.size(); i++)
+		if (pairCounts[i] > 0)
+			pairs.push_back({ (u8)(i >> 8), (u8)(i & 0xFF), pairCounts[i] });
+
+	std::sort(pairs.begin(), pairs.end(), [](const PairCount& l, const PairCount& r) { return l.count > r.count; });
+
+	if (pairs.size() > n)
+		pairs.resize(n);
+
+	return pairs;
+}
+
+std::string CPU::getOpcodeName(u8 opcode)
+{
+	static const char *const names[256] = {
+#define OP(opcode, impl, addrmode, cycles, pagecross) #impl " " #addrmode,
+		OCRNES_OPCODE_TABLE(OP)
+#undef OP
+	};
+
+	return names[opcode];
+}
+
+//--------------//
+// Tracing		//
+//--------------//
+
+void CPU::traceInstruction(u16 addr)
+{
+	// The instruction's bytes are peeked, so tracing has no side effects.
+	TraceEntry entry;
+	entry.cycle = executedCycles;
+	entry.pc = addr;
+	entry.opcode = bus->cpuPeek(addr);
+	entry.operand[0] = bus->cpuPeek(addr + 1);
+	entry.operand[1] = bus->cpuPeek(addr + 2);
+	entry.a = a;
+	entry.x = x;
+	entry.y = y;
+	entry.sp = sp;
+	entry.status = getStatus();
+
+	trace.record(entry);
+}
+
+void CPU::dumpTrace(std::ostream& out) const
+{
+	static const AddrMode modes[256] = {
+#define OP(opcode, impl, addrmode, cycles, pagecross) AddrMode::addrmode,
+		OCRNES_OPCODE_TABLE(OP)
+#undef OP
+	};
+
+	static const char *const mnemonics[256] = {
+#define OP(opcode, impl, addrmode, cycles, pagecross) #impl,
+		OCRNES_OPCODE_TABLE(OP)
+#undef OP
+	};
+
+	for (const TraceEntry& entry : trace.snapshot())
+	{
+		AddrMode mode = modes[entry.opcode];
+		u8 length = lengthOf(mode);
+		u8 lo = entry.operand[0];
+		u16 word = ((u16)entry.operand[1] << 8) | lo;
+
+		char bytes[9];
+		if (length == 1)
+			snprintf(bytes, sizeof(bytes), "%02X", entry.opcode);
+		else if (length == 2)
+			snprintf(bytes, sizeof(bytes), "%02X %02X", entry.opcode, lo);
+		else
+			snprintf(bytes, sizeof(bytes), "%02X %02X %02X", entry.opcode, lo, entry.operand[1]);
+
+		// The operand is written as nestest does, but without the value at the
+		// address, as reading it again could have side effects.
+		char operand[16] = "";
+		switch (mode)
+		{
+		case AddrMode::IMP:
+			// Shifts and rotates of the accumulator.
+			if ((entry.opcode & 0x9F) == 0x0A)
+				snprintf(operand, sizeof(operand), "A");
+			break;
+		case AddrMode::IMM: snprintf(operand, sizeof(operand), "#$%02X", lo); break;
+		case AddrMode::ZP0: snprintf(operand, sizeof(operand), "$%02X", lo); break;
+		case AddrMode::ZPX: snprintf(operand, sizeof(operand), "$%02X,X", lo); break;
+		case AddrMode::ZPY: snprintf(operand, sizeof(operand), "$%02X,Y", lo); break;
+		case AddrMode::REL: snprintf(operand, sizeof(operand), "$%04X", (u16)(entry.pc + 2 + (s8)lo)); break;
+		case AddrMode::ABS: snprintf(operand, sizeof(operand), "$%04X", word); break;
+		case AddrMode::ABX: snprintf(operand, sizeof(operand), "$%04X,X", word); break;
+		case AddrMode::ABY: snprintf(operand, sizeof(operand), "$%04X,Y", word); break;
+		case AddrMode::IND: snprintf(operand, sizeof(operand), "($%04X)", word); break;
+		case AddrMode::IZX: snprintf(operand, sizeof(operand), "($%02X,X)", lo); break;
+		case AddrMode::IZY: snprintf(operand, sizeof(operand), "($%02X),Y", lo); break;
+		}
+
+		char disassembly[32];
+		snprintf(disassembly, sizeof(disassembly), "%s %s", mnemonics[entry.opcode], operand);
+
+		char line[96];
+		snprintf(line, sizeof(line), "%04X  %-8s  %-31s A:%02X X:%02X Y:%02X P:%02X SP:%02X CYC:%llu\n",
+			entry.pc, bytes, disassembly, entry.a, entry.x, entry.y, entry.status, entry.sp,
+			(unsigned long long)entry.cycle);
+		out << line;
+	}
 }
 
 //------------------//
@@ -407,14 +744,45 @@ void CPU::clockCycle()
 
 u8 CPU::getFlag(Flag f)
 {
+	// N and Z are derived from the last result rather than stored.
+	if (f == N)
+		return (nz & 0x0180) ? 1 : 0;
+	if (f == Z)
+		return (nz & 0x00FF) ? 0 : 1;
+
 	return ((status & f) > 0) ? 1 : 0;
 }
 
 void CPU::setFlag(Flag f, bool v)
 {
+	if (f == N || f == Z)
+	{
+		u8 s = getStatus();
+		setStatus(v ? (s | f) : (s & ~f));
+		return;
+	}
+
 	status = v ? (status | f) : (status & ~f);
 }
 
+void CPU::setNZ(u16 result)
+{
+	nz = result;
+}
+
+u8 CPU::getStatus() const
+{
+	return (status & ~(N | Z)) | ((nz & 0x0180) ? N : 0) | ((nz & 0x00FF) ? 0 : Z);
+}
+
+void CPU::setStatus(u8 s)
+{
+	// Encode N in bit 8 and Z as a zero low byte, so that any
+	// combination of the two can be represented.
+	status = s & ~(N | Z);
+	nz = ((s & N) ? 0x0100 : 0x0000) | ((s & Z) ? 0x0000 : 0x0001);
+}
+
 //--------------------------------//
 // Interconnect Linkage	(Private) //
 //--------------------------------//
@@ -427,20 +795,285 @@ u8 CPU::read(u16 a)
 void CPU::write(u16 a, u8 d)
 {
 	bus->cpuWrite(a, d);
+
+	// Stop executing the current block if the write may have changed it.
+	if (blockCache.write(a))
+	{
+		block = nullptr;
+		exitCompiled = true;
+	}
+}
+
+u8 CPU::readRAM(u16 a)
+{
+	assert(a <= 0x07FF);
+	return bus->cpuRAM[a];
+}
+
+void CPU::writeRAM(u16 a, u8 d)
+{
+	assert(a <= 0x07FF);
+	bus->cpuRAM[a] = d;
+
+	// Code can be run from RAM, so may still need to be invalidated.
+	if (blockCache.write(a))
+	{
+		block = nullptr;
+		exitCompiled = true;
+	}
 }
 
+template <CPU::AddrMode M, void (CPU::*Impl)(), bool PageCross>
+u8 CPU::execute()
+{
+	return executeDecoded<M, Impl, PageCross>(readOperand<M>());
+}
+
+template <CPU::AddrMode M, void (CPU::*Impl)(), bool PageCross>
+u8 CPU::executeDecoded(u16 operand)
+{
+	// Only instructions which read an indexed operand take an extra cycle
+	// when a page boundary is crossed, which is known at compile time.
+	u8 crossed = address<M>(operand);
+	(this->*Impl)();
+	return PageCross ? crossed : 0;
+}
+
+template <CPU::AddrMode M, void (CPU::*Impl)(), bool PageCross, u8 Opcode, u8 Cycles>
+u32 CPU::executeCompiled(CPU *cpu, u16 operand, u16 next)
+{
+	if constexpr (TRACING)
+		cpu->traceInstruction(next - lengthOf(M));
+
+	// The same as a step through the block cache, with the
+	// opcode and its base number of cycles known in advance.
+	cpu->curOpcode = Opcode;
+	cpu->pc = next;
+
+	// Unused flag is always set.
+	cpu->setFlag(U, 1);
+
+	cpu->instrCycles = Cycles;
+	u8 extra = cpu->executeDecoded<M, Impl, PageCross>(operand);
+	cpu->instrCycles += extra;
+
+	// Unused flag is always set.
+	cpu->setFlag(U, 1);
+
+	if (cpu->pairProfiling)
+		cpu->profilePair(Opcode);
+
+	cpu->stepCount++;
+	cpu->stepCycles += cpu->instrCycles;
+	cpu->executedCycles += cpu->instrCycles;
+	return cpu->instrCycles;
+}
+
+JIT::Context CPU::compiledContext() const
+{
+	auto offset = [this](const void *member) { return (s32)((const u8*)member - (const u8*)this); };
+
+	JIT::Context context;
+	context.a = offset(&a);
+	context.x = offset(&x);
+	context.y = offset(&y);
+	context.sp = offset(&sp);
+	context.pc = offset(&pc);
+	context.status = offset(&status);
+	context.nz = offset(&nz);
+	context.exit = offset(&exitCompiled);
+	context.stepCount = offset(&stepCount);
+	context.stepCycles = offset(&stepCycles);
+	context.executedCycles = offset(&executedCycles);
+
+	context.ram = bus->cpuRAM;
+	context.codePages = blockCache.getCodePages();
+	context.read = &CPU::compiledRead;
+	context.write = &CPU::compiledWrite;
+	context.thunks = compiledInstructions;
+
+	// Tracing and profiling happen in the handlers.
+	context.handlersOnly = TRACING || pairProfiling;
+	return context;
+}
+
+template <u8 First, u8 Second>
+u8 CPU::executeFused(const BlockCache::Entry *entries, u8 limit)
+{
+	// Both handlers are known at compile time, so are called directly.
+	// The first may write over the second, or stop the run, either of which
+	// sets the exit flag, so the second is then left to be stepped as normal.
+	exitCompiled = false;
+	u8 cycles = compiledInstructions[First](this, entries[0].operand, entries[0].pc + entries[0].length);
+	blockIndex++;
+
+	if (exitCompiled)
+		return cycles;
+
+	// Stepping would have only started the second instruction within the limit.
+	// The limit never reaches past the run's budget, which ends at the bus's
+	// next scheduled event, so no interrupt can be raised before the second
+	// instruction starts, and it is run with the PC an interrupt would see.
+	if (cycles >= limit)
+		return cycles;
+
+	cycles += compiledInstructions[Second](this, entries[1].operand, entries[1].pc + entries[1].length);
+	blockIndex++;
+
+	return cycles;
+}
+
+template <CPU::AddrMode M, void (CPU::*Impl)(), CPU::Access A, bool PageCross, u8 Opcode, u8 Cycles>
+u8 CPU::executeCycleStepped()
+{
+	// Instructions which don't access memory at an address, or only the stack
+	// or zero page, have nothing any other device could see the timing of.
+	if constexpr (A == Access::NONE || M == AddrMode::IMP || M == AddrMode::IMM || M == AddrMode::REL
+		|| M == AddrMode::ZP0 || M == AddrMode::ZPX || M == AddrMode::ZPY)
+	{
+		instrCycles = Cycles;
+		u8 extra = execute<M, Impl, PageCross>();
+		return instrCycles + extra;
+	}
+	else
+	{
+		// Reading the operand and any pointer only touches ROM and the zero page.
+		u8 crossed = address<M>(readOperand<M>());
+		u8 cycles = Cycles + (PageCross ? crossed : 0);
+
+		// Indexing first reads from the address before the carry into its high
+		// byte, taking a cycle which reads only need if there was a carry.
+		if constexpr (M == AddrMode::ABX || M == AddrMode::ABY || M == AddrMode::IZY)
+		{
+			if (A != Access::READ || crossed)
+			{
+				atCycle(cycles - (A == Access::MODIFY ? 4 : 2));
+				read(crossed ? addrAbs - 0x0100 : addrAbs);
+			}
+		}
+
+		if constexpr (A == Access::MODIFY)
+		{
+			// The value read is written back while the result is worked out.
+			atCycle(cycles - 3);
+			fetched = read(addrAbs);
+			atCycle(cycles - 2);
+			write(addrAbs, fetched);
+			atCycle(cycles - 1);
+			write(addrAbs, modify<Opcode>(fetched));
+		}
+		else
+		{
+			// The instruction makes its only access on its last cycle.
+			atCycle(cycles - 1);
+			(this->*Impl)();
+		}
+
+		return cycles;
+	}
+}
+
+template <u8 Opcode>
+u8 CPU::modify(u8 data)
+{
+	// The operation is given by the top 3 bits of the opcode.
+	constexpr u8 op = Opcode >> 5;
+
+	if constexpr (op == 0)		// ASL
+		resBuf = (u16)data << 1;
+	else if constexpr (op == 1)	// ROL
+		resBuf = (u16)(data << 1) | getFlag(C);
+	else if constexpr (op == 2)	// LSR
+		resBuf = data >> 1;
+	else if constexpr (op == 3)	// ROR
+		resBuf = (u16)(getFlag(C) << 7) | (data >> 1);
+	else if constexpr (op == 6)	// DEC
+		resBuf = data - 1;
+	else						// INC
+		resBuf = data + 1;
+
+	// Shifts and rotates carry out the bit shifted out.
+	if constexpr (op == 0 || op == 1)
+		setFlag(C, resBuf & 0xFF00);
+	else if constexpr (op == 2 || op == 3)
+		setFlag(C, data & 0x01);
+
+	setNZ(resBuf & 0x00FF);
+	return resBuf & 0x00FF;
+}
+
+template <CPU::AddrMode M>
+u16 CPU::readOperand()
+{
+	// Implied instructions have no operand, and immediate operands are
+	// left for fetch() to read, as not every instruction uses them.
+	if constexpr (M == AddrMode::IMP)
+		return 0x0000;
+	else if constexpr (M == AddrMode::IMM)
+	{
+		pc++;
+		return 0x0000;
+	}
+	// 16-bit operands.
+	else if constexpr (M == AddrMode::ABS || M == AddrMode::ABX || M == AddrMode::ABY || M == AddrMode::IND)
+	{
+		u16 lo = read(pc);
+		u16 hi = read(pc + 1);
+		pc += 2;
+		return (hi << 8) | lo;
+	}
+	// 8-bit operands.
+	else
+	{
+		u16 operand = read(pc);
+		pc++;
+		return operand;
+	}
+}
+
+template <CPU::AddrMode M>
+u8 CPU::address(u16 operand)
+{
+	if constexpr (M == AddrMode::IMP) return IMP(operand);
+	else if constexpr (M == AddrMode::IMM) return IMM(operand);
+	else if constexpr (M == AddrMode::ZP0) return ZP0(operand);
+	else if constexpr (M == AddrMode::ZPX) return ZPX(operand);
+	else if constexpr (M == AddrMode::ZPY) return ZPY(operand);
+	else if constexpr (M == AddrMode::REL) return REL(operand);
+	else if constexpr (M == AddrMode::ABS) return ABS(operand);
+	else if constexpr (M == AddrMode::ABX) return ABX(operand);
+	else if constexpr (M == AddrMode::ABY) return ABY(operand);
+	else if constexpr (M == AddrMode::IND) return IND(operand);
+	else if constexpr (M == AddrMode::IZX) return IZX(operand);
+	else return IZY(operand);
+}
+
+template <CPU::AddrMode M>
 u8 CPU::fetch()
 {
-	if (!(instructions[curOpcode].addrmode == &CPU::IMP))
+	// Implied instructions operate on the accumulator, which the
+	// addressing mode has already placed in fetched.
+	if constexpr (M == AddrMode::ZP0 || M == AddrMode::ZPX || M == AddrMode::ZPY)
+		fetched = readRAM(addrAbs);
+	else if constexpr (M != AddrMode::IMP)
 		fetched = read(addrAbs);
 	return fetched;
 }
 
+template <CPU::AddrMode M>
+void CPU::store(u8 data)
+{
+	if constexpr (M == AddrMode::ZP0 || M == AddrMode::ZPX || M == AddrMode::ZPY)
+		writeRAM(addrAbs, data);
+	else
+		write(addrAbs, data);
+}
+
 //----------------------//
 // Addressing Modes     //
 //----------------------//
 
-u8 CPU::IMP()
+u8 CPU::IMP(u16 operand)
 {
 	// No extra data needed except possibly the accumulator contents.
 	fetched = a;
@@ -449,53 +1082,49 @@ u8 CPU::IMP()
 	return 0;
 }
 
-u8 CPU::IMM()
+u8 CPU::IMM(u16 operand)
 {
-	// The data is an operand of the instruction, so advance the PC
-	// adn set it as the data address.
-	addrAbs = pc++;
+	// The data is the operand of the instruction, which the PC
+	// has been advanced past, so set it as the data address.
+	addrAbs = pc - 1;
 
 	// Won't require an extra clock cycle.
 	return 0;
 }
 
-u8 CPU::ZP0()
+u8 CPU::ZP0(u16 operand)
 {
 	// The instruction operand is an offset into the Zero Page.
-	addrAbs = read(pc) & 0x00FF;
-	pc++;
+	addrAbs = operand & 0x00FF;
 
 	// Won't require an extra clock cycle.
 	return 0;
 }
 
-u8 CPU::ZPX()
+u8 CPU::ZPX(u16 operand)
 {
 	// The instruction operand is an offset into the Zero Page.
 	// Offset further by the contents of X.
-	addrAbs = (read(pc) + x) & 0x00FF;
-	pc++;
+	addrAbs = (operand + x) & 0x00FF;
 
 	// Won't require an extra clock cycle.
 	return 0;
 }
 
-u8 CPU::ZPY()
+u8 CPU::ZPY(u16 operand)
 {
 	// The instruction operand is an offset into the Zero Page.
 	// Offset further by the contents of X.
-	addrAbs = (read(pc) + y) & 0x00FF;
-	pc++;
+	addrAbs = (operand + y) & 0x00FF;
 
 	// Won't require an extra clock cycle.
 	return 0;
 }
 
-u8 CPU::REL()
+u8 CPU::REL(u16 operand)
 {
 	// Address is a signed 8-bit relative offset from the PC.
-	addrRel = read(pc);
-	pc++;
+	addrRel = operand & 0x00FF;
 
 	// OR the read unsigned address with 0xFF00 if negative.
 	// This allows it to be kept unsigned and added to have the
@@ -507,46 +1136,42 @@ u8 CPU::REL()
 	return 0;
 }
 
-u8 CPU::ABS()
+u8 CPU::ABS(u16 operand)
 {
-	// Read an absolute u16 address from which the
-	// instruction will fetch data.
-	addrAbs = ((u16)read(pc + 1) << 8) | read(pc);
-	pc += 2;
+	// The operand is an absolute u16 address from which
+	// the instruction will fetch data.
+	addrAbs = operand;
 
 	// Won't require an extra clock cycle.
 	return 0;
 }
 
-u8 CPU::ABX()
+u8 CPU::ABX(u16 operand)
 {
-	// Read an absolute u16 address and offset by X.
-	u16 page = read(pc + 1);
-	addrAbs = ((page << 8) | read(pc)) + x;
-	pc += 2;
+	// Offset the absolute u16 address by X.
+	u16 page = operand >> 8;
+	addrAbs = operand + x;
 
 	// If the X offset changes the page, an extra clock
 	// cycle is needed.
 	return ((addrAbs & 0xFF00) != (page << 8)) ? 1 : 0;
 }
 
-u8 CPU::ABY()
+u8 CPU::ABY(u16 operand)
 {
-	// Read an absolute u16 address and offset by Y.
-	u16 page = read(pc + 1);
-	addrAbs = ((page << 8) | read(pc)) + y;
-	pc += 2;
+	// Offset the absolute u16 address by Y.
+	u16 page = operand >> 8;
+	addrAbs = operand + y;
 
 	// If the Y offset changes the page, an extra clock
 	// cycle is needed.
 	return ((addrAbs & 0xFF00) != (page << 8)) ? 1 : 0;
 }
 
-u8 CPU::IND()
+u8 CPU::IND(u16 operand)
 {
-	u16 lo = read(pc);
-	u16 ptr = ((u16)read(pc + 1) << 8) | lo;
-	pc += 2;
+	u16 lo = operand & 0x00FF;
+	u16 ptr = operand;
 
 	// Hardware Bug.
 	// If the low byte of the pointer address is 0xFF,
@@ -563,32 +1188,30 @@ u8 CPU::IND()
 	return 0;
 }
 
-u8 CPU::IZX()
+u8 CPU::IZX(u16 operand)
 {
-	// Read the u8 Zero Page offset at PC.
-	u16 offset = read(pc);
-	pc++;
+	// The operand is a u8 Zero Page offset.
+	u16 offset = operand & 0x00FF;
 
 	// The absolute address is read from the Zero Page
 	// at the read offset, offset by X.
-	addrAbs = ((u16)read((u16)(offset + (u16)x) & 0x00FF) << 8)
-			| read((u16)(offset + (u16)x + 1) & 0x00FF);
+	addrAbs = ((u16)readRAM((u16)(offset + (u16)x) & 0x00FF) << 8)
+			| readRAM((u16)(offset + (u16)x + 1) & 0x00FF);
 
 	// Won't require an extra clock cycle.
 	return 0;
 }
 
-u8 CPU::IZY()
+u8 CPU::IZY(u16 operand)
 {
-	// Read the u8 Zero Page offset at PC.
-	u16 offset = read(pc);
-	pc++;
+	// The operand is a u8 Zero Page offset.
+	u16 offset = operand & 0x00FF;
 
 	// The absolute address is read from the Zero Page
 	// at the read offset, and the read absolute address
 	// is then offset by the contents of Y.
-	u16 page = read((offset + 1) & 0x00FF);
-	addrAbs = ((page << 8) | read(offset & 0x00FF)) + y;
+	u16 page = readRAM((offset + 1) & 0x00FF);
+	addrAbs = ((page << 8) | readRAM(offset & 0x00FF)) + y;
 
 	return ((addrAbs & 0xFF00) != (page << 8)) ? 1 : 0;
 }
@@ -597,123 +1220,118 @@ u8 CPU::IZY()
 // Instructions     //
 //------------------//
 
-u8 CPU::ADC()
+template <CPU::AddrMode M>
+void CPU::ADC()
 {
-	fetch();
+	fetch<M>();
 
 	// u16 addition space for detecting carry.
 	resBuf = (u16)a + (u16)fetched + (u16)getFlag(C);
 
 	// Set flags.
 	setFlag(C, resBuf > 255);
-	setFlag(Z, (resBuf & 0x00FF) == 0);
+	setNZ(resBuf & 0x00FF);
 	setFlag(V, (~((u16)a ^ (u16)fetched) & ((u16)a ^ (u16)resBuf)) & 0x0080);
-	setFlag(N, resBuf & 0x80);
 
 	// Store result in the accumulator.
 	a = resBuf & 0x00FF;
-
-	// May require an additional clock cycle.
-	return 1;
 }
 
-u8 CPU::AND()
+template <CPU::AddrMode M>
+void CPU::AND()
 {
-	fetch();
+	fetch<M>();
 
 	// Perform logical AND.
 	a = a & fetched;
 
-	setFlag(Z, a == 0x00);
-	setFlag(N, a & 0x80);
-
-	// May require an additional clock cycle.
-	return 1;
+	setNZ(a);
 }
 
-u8 CPU::ASL()
+template <CPU::AddrMode M>
+void CPU::ASL()
 {
-	fetch();
+	fetch<M>();
 
 	// Perform Arithmetic Shift Left.
 	resBuf = (u16)fetched << 1;
 
 	// Set flags.
 	setFlag(C, (resBuf & 0xFF00) > 0);
-	setFlag(Z, (resBuf & 0x00FF) == 0x00);
-	setFlag(N, resBuf & 0x80);
+	setNZ(resBuf & 0x00FF);
 
 	// Write the result to the appropriate destination.
-	if (instructions[curOpcode].addrmode == &CPU::IMP)
+	if constexpr (M == AddrMode::IMP)
 		a = resBuf & 0x00FF;
 	else
-		write(addrAbs, resBuf & 0x00FF);
-
-	// Won't require an additional clock cycle.
-	return 0;
+		store<M>(resBuf & 0x00FF);
 }
 
-u8 CPU::BCC()
+template <CPU::AddrMode M>
+void CPU::BCC()
 {
-	return conditionalBranch(getFlag(C) == 0);
+	conditionalBranch(getFlag(C) == 0);
 }
 
-u8 CPU::BCS()
+template <CPU::AddrMode M>
+void CPU::BCS()
 {
-	return conditionalBranch(getFlag(C) == 1);
+	conditionalBranch(getFlag(C) == 1);
 }
 
-u8 CPU::BEQ()
+template <CPU::AddrMode M>
+void CPU::BEQ()
 {
-	return conditionalBranch(getFlag(Z) == 1);
+	conditionalBranch(getFlag(Z) == 1);
 }
 
-u8 CPU::BIT()
+template <CPU::AddrMode M>
+void CPU::BIT()
 {
-	fetch();
+	fetch<M>();
 
 	// Perform logical AND for bit test.
 	resBuf = a & fetched;
 
 	// Set flags according to the result bits.
-	setFlag(Z, (resBuf & 0x00FF) == 0x00);
-	setFlag(N, fetched & (1 << 7));
+	setNZ((resBuf & 0x00FF) | ((fetched & 0x80) << 1));
 	setFlag(V, fetched & (1 << 6));
-
-	// Won't require an extra clock cycle.
-	return 0;
 }
 
-u8 CPU::BMI()
+template <CPU::AddrMode M>
+void CPU::BMI()
 {
-	return conditionalBranch(getFlag(N) == 1);
+	conditionalBranch(getFlag(N) == 1);
 }
 
-u8 CPU::BNE()
+template <CPU::AddrMode M>
+void CPU::BNE()
 {
-	return conditionalBranch(getFlag(Z) == 0);
+	conditionalBranch(getFlag(Z) == 0);
 }
 
-u8 CPU::BPL()
+template <CPU::AddrMode M>
+void CPU::BPL()
 {
-	return conditionalBranch(getFlag(N) == 0);
+	conditionalBranch(getFlag(N) == 0);
 }
 
-u8 CPU::BRK()
+template <CPU::AddrMode M>
+void CPU::BRK()
 {
 	pc++;
 
 	// Push PC to the stack.
-	write(0x0100 + sp, (pc >> 8) & 0x00FF);
+	writeRAM(0x0100 + sp, (pc >> 8) & 0x00FF);
 	sp--;
-	write(0x0100 + sp, pc & 0x00FF);
+	writeRAM(0x0100 + sp, pc & 0x00FF);
 	sp--;
 
 	// Push status register to the stack, with
 	// the Interrupt Disable and Break flags set.
 	setFlag(I, 1);
 	setFlag(B, 1);
-	write(0x0100 + sp, status);
+	writeRAM(0x0100 + sp, getStatus());
 	sp--;
 
 	// Unset the break flag.
@@ -721,450 +1339,374 @@ u8 CPU::BRK()
 
 	// Read the new PC from oxFFFE.
 	pc = ((u16)read(0xFFFF) << 8) | read(0xFFFE);
-
-	// Won't require an extra clock cycle.
-	return 0;
 }
 
-u8 CPU::BVC()
+template <CPU::AddrMode M>
+void CPU::BVC()
 {
-	return conditionalBranch(getFlag(V) == 0);
+	conditionalBranch(getFlag(V) == 0);
 }
 
-u8 CPU::BVS()
+template <CPU::AddrMode M>
+void CPU::BVS()
 {
-	return conditionalBranch(getFlag(V) == 1);
+	conditionalBranch(getFlag(V) == 1);
 }
 
-u8 CPU::CLC()
+template <CPU::AddrMode M>
+void CPU::CLC()
 {
 	// Perform Carry Flag clear.
 	setFlag(C, 0);
-
-	// Won't require an extra clock cycle.
-	return 0;
 }
 
-u8 CPU::CLD()
+template <CPU::AddrMode M>
+void CPU::CLD()
 {
 	// Perform decimal flag clear.
 	setFlag(D, 0);
-
-	// Won't require an extra clock cycle.
-	return 0;
 }
 
-u8 CPU::CLI()
+template <CPU::AddrMode M>
+void CPU::CLI()
 {
 	// Perform Disable Interrupts flag clear.
 	setFlag(I, 0);
-
-	// Won't require an extra clock cycle.
-	return 0;
 }
 
-u8 CPU::CLV()
+template <CPU::AddrMode M>
+void CPU::CLV()
 {
 	// Perform Overflow flag clear.
 	setFlag(V, 0);
-
-	// Won't require an extra clock cycle.
-	return 0;
 }
 
-u8 CPU::CMP()
+template <CPU::AddrMode M>
+void CPU::CMP()
 {
-	fetch();
+	fetch<M>();
 
 	// Perform accumulator comparison.
 	resBuf = (u16)a - (u16)fetched;
 
 	// Set flags.
 	setFlag(C, a >= fetched);
-	setFlag(Z, (resBuf & 0x00FF) == 0x0000);
-	setFlag(N, resBuf & 0x0080);
-
-	// May require an additional clock cycle.
-	return 1;
+	setNZ(resBuf & 0x00FF);
 }
 
-u8 CPU::CPX()
+template <CPU::AddrMode M>
+void CPU::CPX()
 {
-	fetch();
+	fetch<M>();
 
 	// Perform X register comparison.
 	resBuf = (u16)x - (u16)fetched;
 
 	// Set flags.
 	setFlag(C, x >= fetched);
-	setFlag(Z, (resBuf & 0x00FF) == 0x0000);
-	setFlag(N, resBuf & 0x0080);
-
-	// Won't require an extra clock cycle.
-	return 0;
+	setNZ(resBuf & 0x00FF);
 }
 
-u8 CPU::CPY()
+template <CPU::AddrMode M>
+void CPU::CPY()
 {
-	fetch();
+	fetch<M>();
 
 	// Perform Y register comparison.
 	resBuf = (u16)y - (u16)fetched;
 
 	// Set flags.
 	setFlag(C, y >= fetched);
-	setFlag(Z, (resBuf & 0x00FF) == 0x0000);
-	setFlag(N, resBuf & 0x0080);
-
-	// Won't require an extra clock cycle.
-	return 0;
+	setNZ(resBuf & 0x00FF);
 }
 
-u8 CPU::DEC()
+template <CPU::AddrMode M>
+void CPU::DEC()
 {
-	fetch();
+	fetch<M>();
 
 	// Perform decrement on memory location.
 	resBuf = fetched - 1;
-	write(addrAbs, resBuf & 0x00FF);
+	store<M>(resBuf & 0x00FF);
 
 	// Set flags.
-	setFlag(Z, (resBuf & 0x00FF) == 0x0000);
-	setFlag(N, resBuf & 0x0080);
-
-	// Won't require an extra clock cycle.
-	return 0;
+	setNZ(resBuf & 0x00FF);
 }
 
-u8 CPU::DEX()
+template <CPU::AddrMode M>
+void CPU::DEX()
 {
 	// Perform decrement on X register.
 	x--;
 
 	// Set flags.
-	setFlag(Z, x == 0x00);
-	setFlag(N, x & 0x80);
-
-	// Won't require an extra clock cycle.
-	return 0;
+	setNZ(x);
 }
 
-u8 CPU::DEY()
+template <CPU::AddrMode M>
+void CPU::DEY()
 {
 	// Perform decrement on Y register.
 	y--;
 
 	// Set flags.
-	setFlag(Z, y == 0x00);
-	setFlag(N, y & 0x80);
-
-	// Won't require an extra clock cycle.
-	return 0;
+	setNZ(y);
 }
 
-u8 CPU::EOR()
+template <CPU::AddrMode M>
+void CPU::EOR()
 {
-	fetch();
+	fetch<M>();
 
 	// Perform logical XOR.
 	a = a ^ fetched;
 
 	// Set flags.
-	setFlag(Z, a == 0x00);
-	setFlag(N, a & 0x80);
-
-	// May require an extra clock cycle.
-	return 1;
+	setNZ(a);
 }
 
-u8 CPU::INC()
+template <CPU::AddrMode M>
+void CPU::INC()
 {
-	fetch();
+	fetch<M>();
 
 	// Perform increment on memory location.
 	resBuf = fetched + 1;
-	write(addrAbs, resBuf & 0x00FF);
+	store<M>(resBuf & 0x00FF);
 
 	// Set flags.
-	setFlag(Z, (resBuf & 0x00FF) == 0x0000);
-	setFlag(N, resBuf & 0x0080);
-
-	// Won't require an extra clock cycle.
-	return 0;
+	setNZ(resBuf & 0x00FF);
 }
 
-u8 CPU::INX()
+template <CPU::AddrMode M>
+void CPU::INX()
 {
 	// Perform increment on X register.
 	x++;
 
 	// Set flags.
-	setFlag(Z, x == 0x00);
-	setFlag(N, x & 0x80);
-
-	// Won't require an extra clock cycle.
-	return 0;
+	setNZ(x);
 }
 
-u8 CPU::INY()
+template <CPU::AddrMode M>
+void CPU::INY()
 {
 	// Perform increment on Y register.
 	y++;
 
 	// Set flags.
-	setFlag(Z, y == 0x00);
-	setFlag(N, y & 0x80);
-
-	// Won't require an extra clock cycle.
-	return 0;
+	setNZ(y);
 }
 
-u8 CPU::JMP()
+template <CPU::AddrMode M>
+void CPU::JMP()
 {
 	// Perform jump.
 	pc = addrAbs;
-
-	// Won't require an extra clock cycle.
-	return 0;
 }
 
-u8 CPU::JSR()
+template <CPU::AddrMode M>
+void CPU::JSR()
 {
 	pc--;
 
 	// Push PC to the stack.
-	write(0x0100 + sp, (pc >> 8) & 0x00FF);
+	writeRAM(0x0100 + sp, (pc >> 8) & 0x00FF);
 	sp--;
-	write(0x0100 + sp, pc & 0x00FF);
+	writeRAM(0x0100 + sp, pc & 0x00FF);
 	sp--;
 
 	// Perform subroutine jump.
 	pc = addrAbs;
-
-	// Won't require an extra clock cycle.
-	return 0;
 }
 
-u8 CPU::LDA()
+template <CPU::AddrMode M>
+void CPU::LDA()
 {
-	fetch();
+	fetch<M>();
 
 	// Perform load into the accumulator.
 	a = fetched;
 
 	// Set flags.
-	setFlag(Z, a == 0x00);
-	setFlag(N, a & 0x80);
-
-	// May require an extra clock cycle.
-	return 1;
+	setNZ(a);
 }
 
-u8 CPU::LDX()
+template <CPU::AddrMode M>
+void CPU::LDX()
 {
-	fetch();
+	fetch<M>();
 
 	// Perform load into X register.
 	x = fetched;
 
 	// Set flags.
-	setFlag(Z, x == 0x00);
-	setFlag(N, x & 0x80);
-
-	// May require an extra clock cycle.
-	return 1;
+	setNZ(x);
 }
 
-u8 CPU::LDY()
+template <CPU::AddrMode M>
+void CPU::LDY()
 {
-	fetch();
+	fetch<M>();
 
 	//  Perform load into Y register.
 	y = fetched;
 
 	// Set flags.
-	setFlag(Z, y == 0x00);
-	setFlag(N, y & 0x80);
-
-	// May require an extra clock cycle.
-	return 1;
+	setNZ(y);
 }
 
-u8 CPU::LSR()
+template <CPU::AddrMode M>
+void CPU::LSR()
 {
-	fetch();
+	fetch<M>();
 
 	// Perform logical shift right.
 	resBuf = fetched >> 1;
 
 	// Set flags.
 	setFlag(C, fetched & 0x0001);
-	setFlag(Z, (resBuf & 0x00FF) == 0x0000);
-	setFlag(N, resBuf & 0x0080);
+	setNZ(resBuf & 0x00FF);
 
 	// Write result to the appropriate location.
-	if (instructions[curOpcode].addrmode == &CPU::IMP)
+	if constexpr (M == AddrMode::IMP)
 		a = resBuf & 0x00FF;
 	else
-		write(addrAbs, resBuf & 0x00FF);
-
-	// Won't require an extra clock cycle.
-	return 0;
+		store<M>(resBuf & 0x00FF);
 }
 
-u8 CPU::NOP()
+template <CPU::AddrMode M>
+void CPU::NOP()
 {
-	// May require an extra clock cycle.
-	return (curOpcode == 0xFC) ? 1 : 0;
+	// No operation.
 }
 
-u8 CPU::ORA()
+template <CPU::AddrMode M>
+void CPU::ORA()
 {
-	fetch();
+	fetch<M>();
 
 	// Perform logical OR.
 	a = a | fetched;
 
 	// Set flags.
-	setFlag(Z, a == 0x00);
-	setFlag(N, a & 0x80);
-
-	// May require an extra clock cycle.
-	return 1;
+	setNZ(a);
 }
 
-u8 CPU::PHA()
+template <CPU::AddrMode M>
+void CPU::PHA()
 {
 	// Perform accumulator push to the stack.
-	write(0x0100 + sp, a);
+	writeRAM(0x0100 + sp, a);
 	sp--;
-
-	// Won't require an extra clock cycle.
-	return 0;
 }
 
-u8 CPU::PHP()
+template <CPU::AddrMode M>
+void CPU::PHP()
 {
 	// Set Break and Unused flags before push.
 	setFlag(B, 1);
 	setFlag(U, 1);
 
 	// Perform status register push to stack.
-	write(0x0100 + sp, status | B | U);
+	writeRAM(0x0100 + sp, getStatus() | B | U);
 	sp--;
 	setFlag(B, 0);
 	setFlag(U, 0);
-
-	// Won't require an extra clock cycle.
-	return 0;
 }
 
-u8 CPU::PLA()
+template <CPU::AddrMode M>
+void CPU::PLA()
 {
 	// Pop accumulator from the stack.
 	sp++;
-	a = read(0x0100 + sp);
+	a = readRAM(0x0100 + sp);
 
 	// Set flags.
-	setFlag(Z, a == 0x00);
-	setFlag(N, a & 0x80);
-
-	// Won't require an extra clock cycle.
-	return 0;
+	setNZ(a);
 }
 
-u8 CPU::PLP()
+template <CPU::AddrMode M>
+void CPU::PLP()
 {
 	// Pop the status register from the stack.
 	sp++;
-	status = read(0x0100 + sp);
+	setStatus(readRAM(0x0100 + sp));
 
 	// Always set the Unused flag.
 	setFlag(U, 1);
-
-	// Won't require an extra clock cycle.
-	return 0;
 }
 
-u8 CPU::ROL()
+template <CPU::AddrMode M>
+void CPU::ROL()
 {
-	fetch();
+	fetch<M>();
 
 	// Perform Rotate Left Through Carry.
 	resBuf = (u16)(fetched << 1) | getFlag(C);
 
 	// Set flags.
 	setFlag(C, resBuf & 0xFF00);
-	setFlag(Z, (resBuf & 0x00FF) == 0x0000);
-	setFlag(N, resBuf & 0x0080);
+	setNZ(resBuf & 0x00FF);
 
 	// Write result to the appropriate location.
-	if (instructions[curOpcode].addrmode == &CPU::IMP)
+	if constexpr (M == AddrMode::IMP)
 		a = resBuf & 0x00FF;
 	else
-		write(addrAbs, resBuf & 0x00FF);
-
-	// Won't require an extra clock cycle.
-	return 0;
+		store<M>(resBuf & 0x00FF);
 }
 
-u8 CPU::ROR()
+template <CPU::AddrMode M>
+void CPU::ROR()
 {
-	fetch();
+	fetch<M>();
 
 	// Perform Rotate Right Through Carry.
 	resBuf = (u16)(getFlag(C) << 7) | (fetched >> 1);
 
 	// Set flags.
 	setFlag(C, fetched & 0x01);
-	setFlag(Z, (resBuf & 0x00FF) == 0x00);
-	setFlag(N, resBuf & 0x0080);
+	setNZ(resBuf & 0x00FF);
 
 	// Write result to the appropriate location.
-	if (instructions[curOpcode].addrmode == &CPU::IMP)
+	if constexpr (M == AddrMode::IMP)
 		a = resBuf & 0x00FF;
 	else
-		write(addrAbs, resBuf & 0x00FF);
-
-	// Won't require an extra clock cycle.
-	return 0;
+		store<M>(resBuf & 0x00FF);
 }
 
-u8 CPU::RTI()
+template <CPU::AddrMode M>
+void CPU::RTI()
 {
 	// Perform return from interrupt.
 
 	// Pop status register from stack.
 	sp++;
-	status = read(0x0100 + sp);
+	setStatus(readRAM(0x0100 + sp));
 	setFlag(B, 0);
 	setFlag(U, 0);
 
 	// Pop PC from the stack.
-	pc = ((u16)read(0x0100 + sp + 2) << 8) | (u16)read(0x0100 + sp + 1);
+	pc = ((u16)readRAM(0x0100 + sp + 2) << 8) | (u16)readRAM(0x0100 + sp + 1);
 	sp += 2;
-
-	// Won't require an extra clock cycle.
-	return 0;
 }
 
-u8 CPU::RTS()
+template <CPU::AddrMode M>
+void CPU::RTS()
 {
 	// Perform return from subroutine.
 
 	// Pop PC from the stack.
-	pc = ((u16)read(0x0100 + sp + 2) << 8) | (u16)read(0x0100 + sp + 1);
+	pc = ((u16)readRAM(0x0100 + sp + 2) << 8) | (u16)readRAM(0x0100 + sp + 1);
 	sp += 2;
 
 	pc++;
-
-	// Won't require an extra clock cycle.
-	return 0;
 }
 
-u8 CPU::SBC()
+template <CPU::AddrMode M>
+void CPU::SBC()
 {
-	fetch();
+	fetch<M>();
 
 	// 16-bit add space to detect carry.
 
@@ -1176,158 +1718,123 @@ u8 CPU::SBC()
 
 	// Set flags.
 	setFlag(C, resBuf & 0xFF00);
-	setFlag(Z, ((resBuf & 0x00FF) == 0));
+	setNZ(resBuf & 0x00FF);
 	setFlag(V, (resBuf ^ value) & (resBuf ^ (u16)a) & 0x0080);
-	setFlag(N, resBuf & 0x0080);
 
 	// Store result in the accumulator.
 	a = resBuf & 0x00FF;
-
-	// May require an addition clock cycle.
-	return 1;
 }
 
-u8 CPU::SEC()
+template <CPU::AddrMode M>
+void CPU::SEC()
 {
 	// Perform Carry Flag Set.
 	setFlag(C, true);
-
-	// Won't require an extra clock cycle.
-	return 0;
 }
 
-u8 CPU::SED()
+template <CPU::AddrMode M>
+void CPU::SED()
 {
 	// Perform Decimal Flag Set.
 	setFlag(D, true);
-
-	// Won't require an extra clock cycle.
-	return 0;
 }
 
-u8 CPU::SEI()
+template <CPU::AddrMode M>
+void CPU::SEI()
 {
 	// Perform Interrupt Disable Flag set.
 	setFlag(I, true);
-
-	// Won't require an extra clock cycle.
-	return 0;
 }
 
-u8 CPU::STA()
+template <CPU::AddrMode M>
+void CPU::STA()
 {
 	// Store accumulator contents in memory.
-	write(addrAbs, a);
-
-	// Won't require an extra clock cycle.
-	return 0;
+	store<M>(a);
 }
 
-u8 CPU::STX()
+template <CPU::AddrMode M>
+void CPU::STX()
 {
 	// Store X register in memory.
-	write(addrAbs, x);
-
-	// Won't require an extra clock cycle.
-	return 0;
+	store<M>(x);
 }
 
-u8 CPU::STY()
+template <CPU::AddrMode M>
+void CPU::STY()
 {
 	// Store Y register in memory.
-	write(addrAbs, y);
-
-	// Won't require an extra clock cycle.
-	return 0;
+	store<M>(y);
 }
 
-u8 CPU::TAX()
+template <CPU::AddrMode M>
+void CPU::TAX()
 {
 	// Transfer accumulator to X register.
 	x = a;
 
 	// Set flags.
-	setFlag(Z, x == 0x00);
-	setFlag(N, x & 0x80);
-
-	// Won't require an extra clock cycle.
-	return 0;
+	setNZ(x);
 }
 
-u8 CPU::TAY()
+template <CPU::AddrMode M>
+void CPU::TAY()
 {
 	// Transfer accumulator to Y register.
 	y = a;
 
 	// Set flags.
-	setFlag(Z, y == 0x00);
-	setFlag(N, y & 0x80);
-
-	// Won't require an extra clock cycle.
-	return 0;
+	setNZ(y);
 }
 
-u8 CPU::TSX()
+template <CPU::AddrMode M>
+void CPU::TSX()
 {
 	// Transfer SP to the X register.
 	x = sp;
 
 	// Set flags.
-	setFlag(Z, x == 0x00);
-	setFlag(N, x & 0x80);
-
-	// Won't require an extra clock cycle.
-	return 0;
+	setNZ(x);
 }
 
-u8 CPU::TXA()
+template <CPU::AddrMode M>
+void CPU::TXA()
 {
 	// Transfer X register to the accumulator.
 	a = x;
 
 	// Set flags.
-	setFlag(Z, a == 0x00);
-	setFlag(N, a & 0x80);
-
-	// Won't require an extra clock cycle.
-	return 0;
+	setNZ(a);
 }
 
-u8 CPU::TXS()
+template <CPU::AddrMode M>
+void CPU::TXS()
 {
 	// Transfer X register to the stack pointer.
 	sp = x;
-
-	// Won't require an extra clock cycle.
-	return 0;
 }
 
-u8 CPU::TYA()
+template <CPU::AddrMode M>
+void CPU::TYA()
 {
 	// Transfer Y register to the accumulator.
 	a = y;
 
 	// Set flags.
-	setFlag(Z, a == 0x00);
-	setFlag(N, a & 0x80);
-
-	// Won't require an extra clock cycle.
-	return 0;
+	setNZ(a);
 }
 
-u8 CPU::XXX()
+template <CPU::AddrMode M>
+void CPU::XXX()
 {
 	// Capture undefined opcode and do nothing.
-
-	// Won't require an extra clock cycle.
-	return 0;
 }
 
 //----------------------//
 // Instruction Helpers	//
 //----------------------//
 
-u8 CPU::conditionalBranch(bool condition)
+void CPU::conditionalBranch(bool condition)
 {
 	// Only branch if the condition is true.
 	if (condition)
@@ -1346,9 +1853,6 @@ u8 CPU::conditionalBranch(bool condition)
 
 		pc = addrAbs;
 	}
-
-	// Won't require an extra cycle.
-	return 0;
 }
 
 //--------------//
@@ -1363,7 +1867,8 @@ void CPU::writeSaveStateData(std::ofstream& state)
     state.write((char*)&y, sizeof(u8));
     state.write((char*)&sp, sizeof(u8));
     state.write((char*)&pc, sizeof(u16));
-    state.write((char*)&status, sizeof(u8));
+    u8 s = getStatus();
+    state.write((char*)&s, sizeof(u8));
     // 9 bytes.
     state.write((char*)&curOpcode, sizeof(u8));
     state.write((char*)&addrAbs, sizeof(u16));
@@ -1371,6 +1876,8 @@ void CPU::writeSaveStateData(std::ofstream& state)
     state.write((char*)&instrCycles, sizeof(u8));
     state.write((char*)&fetched, sizeof(u8));
     state.write((char*)&resBuf, sizeof(u16));
+    // 8 bytes.
+    state.write((char*)&totalCycles, sizeof(u64));
 }
 
 void CPU::loadSaveStateData(std::ifstream& state)
@@ -1381,7 +1888,9 @@ void CPU::loadSaveStateData(std::ifstream& state)
     state.read((char*)&y, sizeof(u8));
     state.read((char*)&sp, sizeof(u8));
     state.read((char*)&pc, sizeof(u16));
-    state.read((char*)&status, sizeof(u8));
+    u8 s = 0x00;
+    state.read((char*)&s, sizeof(u8));
+    setStatus(s);
     // 9 bytes.
     state.read((char*)&curOpcode, sizeof(u8));
     state.read((char*)&addrAbs, sizeof(u16));
@@ -1389,4 +1898,9 @@ void CPU::loadSaveStateData(std::ifstream& state)
     state.read((char*)&instrCycles, sizeof(u8));
     state.read((char*)&fetched, sizeof(u8));
     state.read((char*)&resBuf, sizeof(u16));
+    // 8 bytes.
+    state.read((char*)&totalCycles, sizeof(u64));
+
+    // Memory is loaded along with the CPU, so decoded code may be stale.
+    invalidateBlockCache();
 }
@@ -0,0 +1,766 @@
+//------------------------------------------------------------------------------//
+//                                                                              //
+//  OCR-NES - An NES Emulator written for the OCR A-Level                       //
+//  Computer Science Programming Project.                                       //
+//                                                                              //
+//  Copyright (C) 2021 - 2022 Conaer Macpherson                                 //
+//                                                                              //
+//------------------------------------------------------------------------------//
+
+/**
+ * @file jit.cpp
+ * @author Conaer Macpherson (Candidate No. 6189)
+ * @brief Compiles blocks of 6502 code to x86-64 machine code.
+ * @version 0.1
+ * @date 2022-03-22
+ *
+ * @copyright Copyright (c) 2021 - 2022
+ *
+ */
+
+#include <jit.h>
+#include <opcodes.h>
+
+#ifdef OCRNES_CPU_JIT
+
+// System Headers.
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Language Headers.
+#include <cassert>
+
+// The size of the code buffer. When it fills, all compiled code is discarded.
+static constexpr size_t CODE_BUFFER_SIZE = 4 * 1024 * 1024;
+
+// An upper bound on the size of a compiled block, including its exits.
+static constexpr size_t MAX_BLOCK_CODE = 128 + BlockCache::MAX_BLOCK_LENGTH * 192;
+
+//------------------//
+// Opcode Table		//
+//------------------//
+
+// The instructions and addressing modes, as named in the opcode table.
+enum class Op : u8
+{
+	ADC, AND, ASL, BCC, BCS, BEQ, BIT, BMI, BNE, BPL, BRK, BVC, BVS, CLC, CLD,
+	CLI, CLV, CMP, CPX, CPY, DEC, DEX, DEY, EOR, INC, INX, INY, JMP, JSR, LDA,
+	LDX, LDY, LSR, NOP, ORA, PHA, PHP, PLA, PLP, ROL, ROR, RTI, RTS, SBC, SEC,
+	SED, SEI, STA, STX, STY, TAX, TAY, TSX, TXA, TXS, TYA, XXX,
+};
+
+enum class Mode : u8
+{
+	IMP, IMM, ZP0,
+	ZPX, ZPY, REL,
+	ABS, ABX, ABY,
+	IND, IZX, IZY,
+};
+
+struct OpInfo
+{
+	Op op;
+	Mode mode;
+	u8 cycles;
+	bool pageCross;
+};
+
+static constexpr OpInfo opcodeInfo[256] = {
+#define OP(opcode, impl, addrmode, cycles, pagecross) { Op::impl, Mode::addrmode, cycles, pagecross != 0 },
+	OCRNES_OPCODE_TABLE(OP)
+#undef OP
+};
+
+// The status flags compiled code changes itself.
+static constexpr u8 FLAG_C = 0x01, FLAG_D = 0x08, FLAG_V = 0x40;
+
+// x86-64 register numbers, as encoded in the reg field of a ModRM byte.
+static constexpr u8 EAX = 0, ECX = 1, EDX = 2, ESI = 6, EDI = 7;
+
+JIT::JIT()
+{
+	void *mem = mmap(nullptr, CODE_BUFFER_SIZE, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+	if (mem != MAP_FAILED)
+	{
+		code = (u8*)mem;
+		size = CODE_BUFFER_SIZE;
+
+		// If the host won't make the memory executable, the CPU interprets instead.
+		if (!protect(0, size, false))
+		{
+			munmap(code, size);
+			code = nullptr;
+			size = 0;
+		}
+	}
+}
+
+JIT::~JIT()
+{
+	if (code != nullptr)
+		munmap(code, size);
+}
+
+JIT::CompiledBlock JIT::compile(const BlockCache::Block& block, const Context& context)
+{
+	if (!enabled() || size - used < MAX_BLOCK_CODE)
+		return nullptr;
+
+	// Only the pages the block can be compiled into are made writable, leaving
+	// the rest of the buffer executable, and its pages' TLB entries intact.
+	// If they can't be written to they stay executable, so compiled code can still run.
+	size_t from = used;
+	if (!protect(from, from + MAX_BLOCK_CODE, true))
+		return nullptr;
+
+	u8 *start = code + used;
+
+	/**
+	 * @brief Where the block is left early after an instruction.
+	 */
+	struct Exit
+	{
+		// The address of the following instruction.
+		u16 pc;
+		// The number of instructions run since the counters were brought up to date.
+		u32 pending;
+		// The rel32 fields of the jumps to the exit.
+		size_t jumps[2];
+		u8 numJumps;
+	};
+
+	Exit exits[BlockCache::MAX_BLOCK_LENGTH];
+	u8 numExits = 0;
+
+	//--------------------------------------------------------------------------//
+	// Register usage, all callee-saved so they survive calls:                  //
+	// rbx: CPU*, r12d: cycles used, r13d: budget, r14: system RAM,             //
+	// r15d: cycles used when the CPU's counters were last brought up to date.  //
+	//--------------------------------------------------------------------------//
+
+	// Prologue. 5 pushes after the return address keep the stack 16 byte aligned.
+	emit8(0x53);							// push rbx
+	emit8(0x41); emit8(0x54);				// push r12
+	emit8(0x41); emit8(0x55);				// push r13
+	emit8(0x41); emit8(0x56);				// push r14
+	emit8(0x41); emit8(0x57);				// push r15
+	emit8(0x48); emit8(0x89); emit8(0xFB);	// mov rbx, rdi
+	emit8(0x41); emit8(0x89); emit8(0xF5);	// mov r13d, esi
+	emit8(0x45); emit8(0x31); emit8(0xE4);	// xor r12d, r12d
+	emit8(0x45); emit8(0x31); emit8(0xFF);	// xor r15d, r15d
+	emit8(0x49); emit8(0xBE);				// mov r14, ram
+	emit64((u64)context.ram);
+
+	// The number of instructions run since the CPU's counters were brought up to date.
+	u32 pending = 0;
+
+	for (u8 i = 0; i < block.count; i++)
+	{
+		const BlockCache::Entry& entry = block.entries[i];
+		const OpInfo& info = opcodeInfo[entry.opcode];
+		u16 next = entry.pc + entry.length;
+		bool last = i + 1 == block.count;
+		bool mayExit = false;
+
+		if (!context.handlersOnly && translatable(entry))
+		{
+			mayExit = emitInstruction(entry, context, pending);
+			pending++;
+
+			// The PC is only stored when the block is left, except by jumps and branches.
+			if (last && info.op != Op::JMP && info.mode != Mode::REL)
+			{
+				emit8(0x66); emit8(0xC7); emitMember(EAX, context.pc);	// mov word [pc], next
+				emit16(next);
+			}
+		}
+		else
+		{
+			// Call the instruction's handler, which counts it itself.
+			emitSync(context, pending);
+			pending = 0;
+
+			emit8(0x48); emit8(0x89); emit8(0xDF);	// mov rdi, rbx
+			emit8(0xBE); emit32(entry.operand);		// mov esi, operand
+			emit8(0xBA); emit32(next);				// mov edx, next
+			emitCall((const void*)context.thunks[entry.opcode]);
+			emit8(0x41); emit8(0x01); emit8(0xC4);	// add r12d, eax
+			emit8(0x45); emit8(0x89); emit8(0xE7);	// mov r15d, r12d
+			mayExit = true;
+		}
+
+		if (!last)
+		{
+			Exit& exit = exits[numExits++];
+			exit.pc = next;
+			exit.pending = pending;
+			exit.numJumps = 0;
+
+			// Exit once the budget has been reached.
+			emit8(0x45); emit8(0x39); emit8(0xEC);	// cmp r12d, r13d
+			emit8(0x0F); emit8(0x83);				// jae exit
+			exit.jumps[exit.numJumps++] = used;
+			emit32(0);
+
+			// Exit if a call asked the CPU to, e.g. because the instruction invalidated code.
+			if (mayExit)
+			{
+				emit8(0x80); emitMember(7, context.exit); emit8(0x00);	// cmp byte [exit], 0
+				emit8(0x0F); emit8(0x85);				// jne exit
+				exit.jumps[exit.numJumps++] = used;
+				emit32(0);
+			}
+		}
+	}
+
+	// The whole block was run.
+	emit8(0xB9); emit32(pending);			// mov ecx, pending
+
+	// Epilogue, bringing the counters up to date and returning the cycles used.
+	size_t epilogue = used;
+	emit8(0x01); emitMember(ECX, context.stepCount);	// add [stepCount], ecx
+	emitSync(context, 0);
+	emit8(0x44); emit8(0x89); emit8(0xE0);	// mov eax, r12d
+	emit8(0x41); emit8(0x5F);				// pop r15
+	emit8(0x41); emit8(0x5E);				// pop r14
+	emit8(0x41); emit8(0x5D);				// pop r13
+	emit8(0x41); emit8(0x5C);				// pop r12
+	emit8(0x5B);							// pop rbx
+	emit8(0xC3);							// ret
+
+	// The early exits store the PC, which is otherwise only known at compile time.
+	for (u8 i = 0; i < numExits; i++)
+	{
+		for (u8 j = 0; j < exits[i].numJumps; j++)
+			patch(exits[i].jumps[j]);
+
+		emit8(0x66); emit8(0xC7); emitMember(EAX, context.pc);	// mov word [pc], next
+		emit16(exits[i].pc);
+		emit8(0xB9); emit32(exits[i].pending);	// mov ecx, pending
+		emit8(0xE9);							// jmp epilogue
+		emit32((u32)(epilogue - (used + 4)));
+	}
+
+	assert(used - from <= MAX_BLOCK_CODE);
+
+	if (!protect(from, from + MAX_BLOCK_CODE, false))
+	{
+		failed = true;
+		return nullptr;
+	}
+
+	return (CompiledBlock)start;
+}
+
+bool JIT::protect(size_t from, size_t to, bool writable)
+{
+	// mprotect() works on whole pages.
+	static const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+	from -= from % pageSize;
+	to = to < size ? to : size;
+
+	return mprotect(code + from, to - from, writable ? (PROT_READ | PROT_WRITE) : (PROT_READ | PROT_EXEC)) == 0;
+}
+
+//------------------//
+// Translation		//
+//------------------//
+
+bool JIT::translatable(const BlockCache::Entry& entry)
+{
+	const OpInfo& info = opcodeInfo[entry.opcode];
+
+	// Indirect addressing is left to the handlers.
+	bool direct = info.mode == Mode::IMM || info.mode == Mode::ZP0 || info.mode == Mode::ZPX
+		|| info.mode == Mode::ZPY || info.mode == Mode::ABS || info.mode == Mode::ABX || info.mode == Mode::ABY;
+
+	switch (info.op)
+	{
+	case Op::LDA: case Op::LDX: case Op::LDY:
+	case Op::ADC: case Op::SBC: case Op::AND: case Op::ORA: case Op::EOR:
+	case Op::CMP: case Op::CPX: case Op::CPY:
+		return direct;
+
+	case Op::STA: case Op::STX: case Op::STY:
+		return direct && info.mode != Mode::IMM;
+
+	// Read-modify-write instructions, only in the zero page.
+	case Op::INC: case Op::DEC:
+		return info.mode == Mode::ZP0 || info.mode == Mode::ZPX;
+
+	// Shifts and rotates, only of the accumulator.
+	case Op::ASL: case Op::LSR: case Op::ROL: case Op::ROR:
+		return info.mode == Mode::IMP;
+
+	case Op::INX: case Op::INY: case Op::DEX: case Op::DEY:
+	case Op::TAX: case Op::TAY: case Op::TXA: case Op::TYA: case Op::TSX: case Op::TXS:
+	case Op::CLC: case Op::SEC: case Op::CLV: case Op::CLD: case Op::SED:
+	case Op::BCC: case Op::BCS: case Op::BEQ: case Op::BNE:
+	case Op::BMI: case Op::BPL: case Op::BVC: case Op::BVS:
+		return true;
+
+	case Op::NOP:
+		return info.mode == Mode::IMP;
+
+	case Op::JMP:
+		return info.mode == Mode::ABS;
+
+	default:
+		return false;
+	}
+}
+
+bool JIT::emitInstruction(const BlockCache::Entry& entry, const Context& context, u32& pending)
+{
+	const OpInfo& info = opcodeInfo[entry.opcode];
+	bool mayExit = false;
+
+	// The register an instruction works on, by its name.
+	s32 reg = context.a;
+	if (info.op == Op::LDX || info.op == Op::STX || info.op == Op::CPX || info.op == Op::INX || info.op == Op::DEX)
+		reg = context.x;
+	else if (info.op == Op::LDY || info.op == Op::STY || info.op == Op::CPY || info.op == Op::INY || info.op == Op::DEY)
+		reg = context.y;
+
+	switch (info.op)
+	{
+	case Op::LDA: case Op::LDX: case Op::LDY:
+		mayExit = emitRead(entry, context, pending);
+		emit8(0x88); emitMember(EAX, reg);					// mov [reg], al
+		emit8(0x66); emit8(0x89); emitMember(EAX, context.nz);	// mov [nz], ax
+		break;
+
+	case Op::AND: case Op::ORA: case Op::EOR:
+		mayExit = emitRead(entry, context, pending);
+		emit8(info.op == Op::AND ? 0x22 : info.op == Op::ORA ? 0x0A : 0x32);
+		emitMember(EAX, context.a);							// and/or/xor al, [a]
+		emit8(0x88); emitMember(EAX, context.a);			// mov [a], al
+		emit8(0x66); emit8(0x89); emitMember(EAX, context.nz);	// mov [nz], ax
+		break;
+
+	case Op::CMP: case Op::CPX: case Op::CPY:
+		mayExit = emitRead(entry, context, pending);
+		emit8(0x0F); emit8(0xB6); emitMember(ECX, reg);		// movzx ecx, byte [reg]
+		emit8(0x28); emit8(0xC1);							// sub cl, al
+		emit8(0x0F); emit8(0x93); emit8(0xC0);				// setnc al
+		emit8(0x66); emit8(0x89); emitMember(ECX, context.nz);	// mov [nz], cx
+		emit8(0x80); emitMember(4, context.status); emit8((u8)~FLAG_C);	// and byte [status], ~C
+		emit8(0x08); emitMember(EAX, context.status);		// or [status], al
+		break;
+
+	case Op::ADC: case Op::SBC:
+		// The 6502's carry is the inverse of the x86 borrow when subtracting,
+		// but its overflow flag is the same as the x86 one either way.
+		mayExit = emitRead(entry, context, pending);
+		emit8(0x0F); emit8(0xB6); emitMember(ECX, context.a);		// movzx ecx, byte [a]
+		emit8(0x0F); emit8(0xB6); emitMember(EDX, context.status);	// movzx edx, byte [status]
+		emit8(0x0F); emit8(0xBA); emit8(0xE2); emit8(0x00);		// bt edx, 0
+		if (info.op == Op::SBC)
+		{
+			emit8(0xF5);									// cmc
+			emit8(0x18); emit8(0xC1);						// sbb cl, al
+			emit8(0x0F); emit8(0x93); emit8(0xC0);			// setnc al
+		}
+		else
+		{
+			emit8(0x10); emit8(0xC1);						// adc cl, al
+			emit8(0x0F); emit8(0x92); emit8(0xC0);			// setc al
+		}
+		emit8(0x0F); emit8(0x90); emit8(0xC2);				// seto dl
+		emit8(0x88); emitMember(ECX, context.a);			// mov [a], cl
+		emit8(0x66); emit8(0x89); emitMember(ECX, context.nz);	// mov [nz], cx
+		emit8(0xC0); emit8(0xE2); emit8(0x06);				// shl dl, 6
+		emit8(0x08); emit8(0xD0);							// or al, dl
+		emit8(0x80); emitMember(4, context.status); emit8((u8)~(FLAG_C | FLAG_V));	// and byte [status], ~(C | V)
+		emit8(0x08); emitMember(EAX, context.status);		// or [status], al
+		break;
+
+	case Op::STA: case Op::STX: case Op::STY:
+		emit8(0x0F); emit8(0xB6); emitMember(EAX, reg);		// movzx eax, byte [reg]
+		mayExit = emitWrite(entry, context, pending);
+		break;
+
+	case Op::INC: case Op::DEC:
+	{
+		// Only ever in the zero page, so in RAM.
+		u8 ext = info.op == Op::INC ? 0 : 1;
+		if (info.mode == Mode::ZP0)
+		{
+			emit8(0x41); emit8(0xFE); emitRAM(ext, entry.operand & 0xFF);	// inc/dec byte [r14 + zp]
+			emit8(0x41); emit8(0x0F); emit8(0xB6); emitRAM(EAX, entry.operand & 0xFF);	// movzx eax, byte [r14 + zp]
+			emit8(0xBE); emit32(entry.operand & 0xFF);		// mov esi, zp
+		}
+		else
+		{
+			emit8(0x0F); emit8(0xB6); emitMember(ESI, context.x);	// movzx esi, byte [x]
+			emit8(0x81); emit8(0xC6); emit32(entry.operand & 0xFF);	// add esi, zp
+			emit8(0x81); emit8(0xE6); emit32(0xFF);			// and esi, 0xFF
+			emit8(0x41); emit8(0xFE); emit8(ext == 0 ? 0x04 : 0x0C); emit8(0x36);	// inc/dec byte [r14 + rsi]
+			emit8(0x41); emit8(0x0F); emit8(0xB6); emit8(0x04); emit8(0x36);	// movzx eax, byte [r14 + rsi]
+		}
+		emit8(0x66); emit8(0x89); emitMember(EAX, context.nz);	// mov [nz], ax
+		emitCodeCheck(context, 0);
+		mayExit = true;
+		break;
+	}
+
+	case Op::ASL: case Op::LSR: case Op::ROL: case Op::ROR:
+		emit8(0x0F); emit8(0xB6); emitMember(EAX, context.a);	// movzx eax, byte [a]
+		if (info.op == Op::ROL || info.op == Op::ROR)
+		{
+			emit8(0x0F); emit8(0xB6); emitMember(EDX, context.status);	// movzx edx, byte [status]
+			emit8(0x0F); emit8(0xBA); emit8(0xE2); emit8(0x00);	// bt edx, 0
+		}
+		emit8(0xD0);
+		emit8(info.op == Op::ASL ? 0xE0 : info.op == Op::LSR ? 0xE8 : info.op == Op::ROL ? 0xD0 : 0xD8);	// shl/shr/rcl/rcr al, 1
+		emit8(0x0F); emit8(0x92); emit8(0xC1);				// setc cl
+		emit8(0x88); emitMember(EAX, context.a);			// mov [a], al
+		emit8(0x66); emit8(0x89); emitMember(EAX, context.nz);	// mov [nz], ax
+		emit8(0x80); emitMember(4, context.status); emit8((u8)~FLAG_C);	// and byte [status], ~C
+		emit8(0x08); emitMember(ECX, context.status);		// or [status], cl
+		break;
+
+	case Op::INX: case Op::INY: case Op::DEX: case Op::DEY:
+		emit8(0xFE); emitMember(info.op == Op::INX || info.op == Op::INY ? 0 : 1, reg);	// inc/dec byte [reg]
+		emit8(0x0F); emit8(0xB6); emitMember(EAX, reg);		// movzx eax, byte [reg]
+		emit8(0x66); emit8(0x89); emitMember(EAX, context.nz);	// mov [nz], ax
+		break;
+
+	case Op::TAX: case Op::TAY: case Op::TXA: case Op::TYA: case Op::TSX: case Op::TXS:
+	{
+		s32 src = info.op == Op::TAX || info.op == Op::TAY ? context.a
+			: info.op == Op::TXA || info.op == Op::TXS ? context.x
+			: info.op == Op::TYA ? context.y : context.sp;
+		s32 dst = info.op == Op::TXA || info.op == Op::TYA ? context.a
+			: info.op == Op::TAX || info.op == Op::TSX ? context.x
+			: info.op == Op::TAY ? context.y : context.sp;
+
+		emit8(0x0F); emit8(0xB6); emitMember(EAX, src);		// movzx eax, byte [src]
+		emit8(0x88); emitMember(EAX, dst);					// mov [dst], al
+
+		// Only TXS leaves the flags alone.
+		if (info.op != Op::TXS)
+		{
+			emit8(0x66); emit8(0x89); emitMember(EAX, context.nz);	// mov [nz], ax
+		}
+		break;
+	}
+
+	case Op::CLC: case Op::CLV: case Op::CLD:
+	{
+		u8 flag = info.op == Op::CLC ? FLAG_C : info.op == Op::CLV ? FLAG_V : FLAG_D;
+		emit8(0x80); emitMember(4, context.status); emit8((u8)~flag);	// and byte [status], ~flag
+		break;
+	}
+
+	case Op::SEC: case Op::SED:
+		emit8(0x80); emitMember(1, context.status);			// or byte [status], flag
+		emit8(info.op == Op::SEC ? FLAG_C : FLAG_D);
+		break;
+
+	case Op::NOP:
+		break;
+
+	case Op::JMP:
+		emit8(0x66); emit8(0xC7); emitMember(EAX, context.pc);	// mov word [pc], target
+		emit16(entry.operand);
+		break;
+
+	default:
+	{
+		// A conditional branch, whose target and cycles are known at compile time.
+		u16 next = entry.pc + entry.length;
+		u16 target = next + (s8)(entry.operand & 0xFF);
+		u8 taken = info.cycles + 1 + ((target & 0xFF00) != (next & 0xFF00) ? 1 : 0);
+
+		// Z is set if the low byte of nz is zero, and N if bit 7 or 8 is.
+		if (info.op == Op::BEQ || info.op == Op::BNE)
+		{
+			emit8(0xF6); emitMember(EAX, context.nz); emit8(0xFF);	// test byte [nz], 0xFF
+		}
+		else if (info.op == Op::BMI || info.op == Op::BPL)
+		{
+			emit8(0x66); emit8(0xF7); emitMember(EAX, context.nz); emit16(0x0180);	// test word [nz], 0x0180
+		}
+		else
+		{
+			emit8(0xF6); emitMember(EAX, context.status);	// test byte [status], flag
+			emit8(info.op == Op::BCC || info.op == Op::BCS ? FLAG_C : FLAG_V);
+		}
+
+		// Taken if the flag tested is set, except for Z, which is set when the test gives zero.
+		bool takenIfSet = info.op == Op::BNE || info.op == Op::BMI || info.op == Op::BCS || info.op == Op::BVS;
+		emit8(takenIfSet ? 0x75 : 0x74);					// jne/je taken
+		size_t toTaken = used;
+		emit8(0x00);
+
+		emit8(0x66); emit8(0xC7); emitMember(EAX, context.pc);	// mov word [pc], next
+		emit16(next);
+		emit8(0x41); emit8(0x83); emit8(0xC4); emit8(info.cycles);	// add r12d, cycles
+		emit8(0xEB);										// jmp done
+		size_t toDone = used;
+		emit8(0x00);
+
+		code[toTaken] = (u8)(used - (toTaken + 1));
+		emit8(0x66); emit8(0xC7); emitMember(EAX, context.pc);	// mov word [pc], target
+		emit16(target);
+		emit8(0x41); emit8(0x83); emit8(0xC4); emit8(taken);	// add r12d, taken
+		code[toDone] = (u8)(used - (toDone + 1));
+
+		return false;
+	}
+	}
+
+	emit8(0x41); emit8(0x83); emit8(0xC4); emit8(info.cycles);	// add r12d, cycles
+	return mayExit;
+}
+
+bool JIT::emitRead(const BlockCache::Entry& entry, const Context& context, u32& pending)
+{
+	const OpInfo& info = opcodeInfo[entry.opcode];
+	s32 index = info.mode == Mode::ZPX || info.mode == Mode::ABX ? context.x : context.y;
+	bool called = false;
+
+	switch (info.mode)
+	{
+	case Mode::IMM:
+		emit8(0xB8); emit32(entry.operand & 0xFF);			// mov eax, imm
+		break;
+
+	case Mode::ZP0:
+		emit8(0x41); emit8(0x0F); emit8(0xB6); emitRAM(EAX, entry.operand & 0xFF);	// movzx eax, byte [r14 + zp]
+		break;
+
+	case Mode::ZPX: case Mode::ZPY:
+		emit8(0x0F); emit8(0xB6); emitMember(ESI, index);	// movzx esi, byte [index]
+		emit8(0x81); emit8(0xC6); emit32(entry.operand & 0xFF);	// add esi, zp
+		emit8(0x81); emit8(0xE6); emit32(0xFF);				// and esi, 0xFF
+		emit8(0x41); emit8(0x0F); emit8(0xB6); emit8(0x04); emit8(0x36);	// movzx eax, byte [r14 + rsi]
+		break;
+
+	case Mode::ABS:
+		if (entry.operand <= 0x1FFF)
+		{
+			emit8(0x41); emit8(0x0F); emit8(0xB6); emitRAM(EAX, entry.operand);	// movzx eax, byte [r14 + addr]
+			break;
+		}
+
+		emitSync(context, pending);
+		pending = 0;
+		emit8(0x48); emit8(0x89); emit8(0xDF);				// mov rdi, rbx
+		emit8(0xBE); emit32(entry.operand);					// mov esi, addr
+		emitCall((const void*)context.read);
+		emit8(0x0F); emit8(0xB6); emit8(0xC0);				// movzx eax, al
+		called = true;
+		break;
+
+	default:
+		// Absolute indexed, read directly if every index stays within RAM.
+		emit8(0x0F); emit8(0xB6); emitMember(ESI, index);	// movzx esi, byte [index]
+		emit8(0x81); emit8(0xC6); emit32(entry.operand);	// add esi, addr
+
+		if (entry.operand + 0xFF <= 0x1FFF)
+		{
+			emit8(0x81); emit8(0xE6); emit32(0x07FF);		// and esi, 0x7FF
+			emit8(0x41); emit8(0x0F); emit8(0xB6); emit8(0x04); emit8(0x36);	// movzx eax, byte [r14 + rsi]
+		}
+		else
+		{
+			emit8(0x81); emit8(0xE6); emit32(0xFFFF);		// and esi, 0xFFFF
+			emitSync(context, pending);
+			pending = 0;
+			emit8(0x48); emit8(0x89); emit8(0xDF);			// mov rdi, rbx
+			emitCall((const void*)context.read);
+			emit8(0x0F); emit8(0xB6); emit8(0xC0);			// movzx eax, al
+			called = true;
+		}
+
+		// A page is crossed if adding the index carries into the high byte.
+		if (info.pageCross)
+		{
+			emit8(0x0F); emit8(0xB6); emitMember(ECX, index);	// movzx ecx, byte [index]
+			emit8(0x81); emit8(0xC1); emit32(entry.operand & 0xFF);	// add ecx, addr & 0xFF
+			emit8(0xC1); emit8(0xE9); emit8(0x08);			// shr ecx, 8
+			emit8(0x41); emit8(0x01); emit8(0xCC);			// add r12d, ecx
+		}
+		break;
+	}
+
+	return called;
+}
+
+bool JIT::emitWrite(const BlockCache::Entry& entry, const Context& context, u32& pending)
+{
+	const OpInfo& info = opcodeInfo[entry.opcode];
+	s32 index = info.mode == Mode::ZPX || info.mode == Mode::ABX ? context.x : context.y;
+
+	switch (info.mode)
+	{
+	case Mode::ZP0:
+		emit8(0x41); emit8(0x88); emitRAM(EAX, entry.operand & 0xFF);	// mov [r14 + zp], al
+		emit8(0xBE); emit32(entry.operand & 0xFF);			// mov esi, zp
+		emitCodeCheck(context, 0);
+		return true;
+
+	case Mode::ZPX: case Mode::ZPY:
+		emit8(0x0F); emit8(0xB6); emitMember(ESI, index);	// movzx esi, byte [index]
+		emit8(0x81); emit8(0xC6); emit32(entry.operand & 0xFF);	// add esi, zp
+		emit8(0x81); emit8(0xE6); emit32(0xFF);				// and esi, 0xFF
+		emit8(0x41); emit8(0x88); emit8(0x04); emit8(0x36);	// mov [r14 + rsi], al
+		emitCodeCheck(context, 0);
+		return true;
+
+	case Mode::ABS:
+		if (entry.operand <= 0x1FFF)
+		{
+			emit8(0x41); emit8(0x88); emitRAM(EAX, entry.operand);	// mov [r14 + addr], al
+			emit8(0xBE); emit32(entry.operand & 0x07FF);	// mov esi, addr
+			emitCodeCheck(context, (entry.operand & 0x07FF) >> 8);
+			return true;
+		}
+
+		emitSync(context, pending);
+		pending = 0;
+		emit8(0x48); emit8(0x89); emit8(0xDF);				// mov rdi, rbx
+		emit8(0xBE); emit32(entry.operand);					// mov esi, addr
+		emit8(0x0F); emit8(0xB6); emit8(0xD0);				// movzx edx, al
+		emitCall((const void*)context.write);
+		return true;
+
+	default:
+		// Absolute indexed, written directly if every index stays within RAM.
+		emit8(0x0F); emit8(0xB6); emitMember(ESI, index);	// movzx esi, byte [index]
+		emit8(0x81); emit8(0xC6); emit32(entry.operand);	// add esi, addr
+
+		if (entry.operand + 0xFF <= 0x1FFF)
+		{
+			emit8(0x81); emit8(0xE6); emit32(0x07FF);		// and esi, 0x7FF
+			emit8(0x41); emit8(0x88); emit8(0x04); emit8(0x36);	// mov [r14 + rsi], al
+			emitCodeCheck(context, -1);
+			return true;
+		}
+
+		emit8(0x81); emit8(0xE6); emit32(0xFFFF);			// and esi, 0xFFFF
+		emitSync(context, pending);
+		pending = 0;
+		emit8(0x48); emit8(0x89); emit8(0xDF);				// mov rdi, rbx
+		emit8(0x0F); emit8(0xB6); emit8(0xD0);				// movzx edx, al
+		emitCall((const void*)context.write);
+		return true;
+	}
+}
+
+void JIT::emitCodeCheck(const Context& context, s32 page)
+{
+	emit8(0x48); emit8(0xB9); emit64((u64)context.codePages);	// mov rcx, codePages
+	size_t toSkip;
+
+	if (page >= 0)
+	{
+		emit8(0xF6); emit8(0x01); emit8((u8)(1 << page));	// test byte [rcx], 1 << page
+		emit8(0x74);										// jz skip
+	}
+	else
+	{
+		emit8(0x89); emit8(0xF2);							// mov edx, esi
+		emit8(0xC1); emit8(0xEA); emit8(0x08);				// shr edx, 8
+		emit8(0x48); emit8(0x8B); emit8(0x09);				// mov rcx, [rcx]
+		emit8(0x48); emit8(0x0F); emit8(0xA3); emit8(0xD1);	// bt rcx, rdx
+		emit8(0x73);										// jnc skip
+	}
+
+	toSkip = used;
+	emit8(0x00);
+
+	// The page holds code, so the write is made again through the CPU, which
+	// invalidates the code and asks for the block to be left.
+	emit8(0x48); emit8(0x89); emit8(0xDF);					// mov rdi, rbx
+	emit8(0x0F); emit8(0xB6); emit8(0xD0);					// movzx edx, al
+	emitCall((const void*)context.write);
+
+	code[toSkip] = (u8)(used - (toSkip + 1));
+}
+
+void JIT::emitSync(const Context& context, u32 pending)
+{
+	if (pending > 0)
+	{
+		emit8(0x81); emitMember(EAX, context.stepCount); emit32(pending);	// add dword [stepCount], pending
+	}
+
+	emit8(0x44); emit8(0x89); emit8(0xE7);					// mov edi, r12d
+	emit8(0x44); emit8(0x29); emit8(0xFF);					// sub edi, r15d
+	emit8(0x01); emitMember(EDI, context.stepCycles);		// add [stepCycles], edi
+	emit8(0x48); emit8(0x01); emitMember(EDI, context.executedCycles);	// add [executedCycles], rdi
+	emit8(0x45); emit8(0x89); emit8(0xE7);					// mov r15d, r12d
+}
+
+void JIT::emitCall(const void *function)
+{
+	emit8(0x48); emit8(0xB8);								// mov rax, function
+	emit64((u64)function);
+	emit8(0xFF); emit8(0xD0);								// call rax
+}
+
+//------------------//
+// Encoding			//
+//------------------//
+
+void JIT::emit8(u8 v)
+{
+	code[used++] = v;
+}
+
+void JIT::emit16(u16 v)
+{
+	emit8(v & 0xFF);
+	emit8(v >> 8);
+}
+
+void JIT::emit32(u32 v)
+{
+	for (u8 i = 0; i < 4; i++)
+		emit8((v >> (i * 8)) & 0xFF);
+}
+
+void JIT::emit64(u64 v)
+{
+	for (u8 i = 0; i < 8; i++)
+		emit8((v >> (i * 8)) & 0xFF);
+}
+
+void JIT::emitMember(u8 reg, s32 offset)
+{
+	// mod 10, rm 011: [rbx + disp32].
+	emit8(0x83 | ((reg & 7) << 3));
+	emit32((u32)offset);
+}
+
+void JIT::emitRAM(u8 reg, u16 addr)
+{
+	// mod 10, rm 110 with REX.B: [r14 + disp32].
+	emit8(0x86 | ((reg & 7) << 3));
+	emit32(addr & 0x07FF);
+}
+
+void JIT::patch(size_t field)
+{
+	u32 rel = (u32)(used - (field + 4));
+	for (u8 b = 0; b < 4; b++)
+		code[field + b] = (rel >> (b * 8)) & 0xFF;
+}
+
+#else
+
+// The JIT isn't built, so there is never any code to run.
+JIT::JIT() {}
+JIT::~JIT() {}
+
+JIT::CompiledBlock JIT::compile(const BlockCache::Block& block, const Context& context)
+{
+	return nullptr;
+}
+
+#endif
@@ -32,20 +32,18 @@ Mapper::~Mapper() {}
 
 void Mapper::reset() {}
 
-Mirror Mapper::mirror()
+void Mapper::connectInterrupts(InterruptLines *lines)
 {
-	return Mirror::HARDWARE;
+	this->interrupts = lines;
 }
 
-bool Mapper::irqState()
+void Mapper::scanline() {}
+
+bool Mapper::scanlineIRQ()
 {
 	return false;
 }
 
-void Mapper::irqClear() {}
-
-void Mapper::scanline() {}
-
 void Mapper::writeSaveStateData(std::ofstream& state) {}
 
 void Mapper::loadSaveStateData(std::ifstream& state) {}
\ No newline at end of file
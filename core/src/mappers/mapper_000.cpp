@@ -56,33 +56,6 @@ bool Mapper_000::cpuMapWrite(u16 addr, u32 &mappedAddr, u8 data)
 	return false;
 }
 
-bool Mapper_000::ppuMapRead(u16 addr, u32 &mappedAddr)
-{
-	// No PPU mapping required.
-	if (addr >= 0x0000 && addr <= 0x1FFF)
-	{
-		mappedAddr = addr;
-		return true;
-	}
-
-	return false;
-}
-
-bool Mapper_000::ppuMapWrite(u16 addr, u32 &mappedAddr)
-{
-	if (addr >= 0x0000 && addr <= 0x1FFF)
-	{
-		// No mapping.
-		if (chrBanks == 0)
-		{
-			mappedAddr = addr;
-			return true;
-		}
-	}
-
-	return false;
-}
-
 //--------------//
 // SaveState	//
 //--------------//
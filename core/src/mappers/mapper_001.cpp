@@ -178,60 +178,6 @@ bool Mapper_001::cpuMapWrite(u16 addr, u32 &mappedAddr, u8 data)
     return false;
 }
 
-bool Mapper_001::ppuMapRead(u16 addr, u32 &mappedAddr)
-{
-    if (addr < 0x2000)
-    {
-        if (chrBanks == 0)
-        {
-            mappedAddr = addr;
-            return true;
-        }
-        else
-        {
-            if (controlRegister & 0b10000)
-            {
-                // 4KB CHR bank mode.
-                if (addr >= 0x0000 && addr <= 0x0FFF)
-                {
-                    mappedAddr = chrBankSelect4LO * 0x1000 + (addr & 0x0FFF);
-                    return true;
-                }
-
-                if (addr >= 0x1000 && addr <= 0x1FFF)
-                {
-                    mappedAddr = chrBankSelect4HI * 0x1000 + (addr & 0x0FFF);
-                    return true;
-                }
-            }
-            else
-            {
-                // 8KB CHR bank mode.
-                mappedAddr = chrBankSelect8 * 0x2000 + (addr & 0x1FFF);
-                return true;
-            }
-        }
-    }
-
-    return false;
-}
-
-bool Mapper_001::ppuMapWrite(u16 addr, u32 &mappedAddr)
-{
-    if (addr < 0x2000)
-    {
-        if (chrBanks == 0)
-        {
-            mappedAddr = addr;
-            return true;
-        }
-
-        return true;
-    }
-    else
-        return false;
-}
-
 void Mapper_001::reset()
 {
     controlRegister = 0x1C;
@@ -247,11 +193,6 @@ void Mapper_001::reset()
     prgBankSelect16HI = prgBanks - 1;
 }
 
-Mirror Mapper_001::mirror()
-{
-    return mirrormode;
-}
-
 //--------------//
 // SaveState    //
 //--------------//
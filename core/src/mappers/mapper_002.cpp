@@ -51,28 +51,6 @@ bool Mapper_002::cpuMapWrite(u16 addr, u32 &mappedAddr, u8 data)
     return false;
 }
 
-bool Mapper_002::ppuMapRead(u16 addr, u32 &mappedAddr)
-{
-    if (addr < 0x2000)
-    {
-        mappedAddr = addr;
-        return true;
-    }
-    else
-        return false;
-}
-
-bool Mapper_002::ppuMapWrite(u16 addr, u32 &mappedAddr)
-{
-    // No mapping.
-    if (addr < 0x2000 && chrBanks == 0)
-    {
-        mappedAddr = addr;
-        return true;
-    }
-    return false;
-}
-
 void Mapper_002::reset()
 {
     prgBankSelectLO = 0;
@@ -52,22 +52,6 @@ bool Mapper_003::cpuMapWrite(u16 addr, u32& mappedAddr, u8 data)
 	return false;
 }
 
-bool Mapper_003::ppuMapRead(u16 addr, u32& mappedAddr)
-{
-	if (addr < 0x2000)
-	{
-		mappedAddr = chrBankSelect * 0x2000 + addr;
-		return true;
-	}
-	else
-		return false;
-}
-
-bool Mapper_003::ppuMapWrite(u16 addr, u32& mappedAddr)
-{
-	return false;
-}
-
 void Mapper_003::reset()
 {
 	chrBankSelect = 0;
@@ -157,8 +157,10 @@ bool Mapper_004::cpuMapWrite(u16 addr, u32& mappedAddr, u8 data)
     {
         if (!(addr & 0x0001))
         {
+            // Disabling the IRQ also acknowledges a pending one.
             irqEnable = false;
             irqActive = false;
+            setIRQ(false);
         }
         else
             irqEnable = true;
@@ -169,57 +171,6 @@ bool Mapper_004::cpuMapWrite(u16 addr, u32& mappedAddr, u8 data)
     return false;
 }
 
-bool Mapper_004::ppuMapRead(u16 addr, u32& mappedAddr)
-{
-    if (addr >= 0x0000 && addr <= 0x03FF)
-    {
-        mappedAddr = chrBank[0] + (addr & 0x03FF);
-        return true;
-    }
-    else if (addr >= 0x0400 && addr <= 0x07FF)
-    {
-        mappedAddr = chrBank[1] + (addr & 0x03FF);
-        return true;
-    }
-    else if (addr >= 0x0800 && addr <= 0x0BFF)
-    {
-        mappedAddr = chrBank[2] + (addr & 0x03FF);
-        return true;
-    }
-    else if (addr >= 0x0C00 && addr <= 0x0FFF)
-    {
-        mappedAddr = chrBank[3] + (addr & 0x03FF);
-        return true;
-    }
-    else if (addr >= 0x1000 && addr <= 0x13FF)
-    {
-        mappedAddr = chrBank[4] + (addr & 0x03FF);
-        return true;
-    }
-    else if (addr >= 0x1400 && addr <= 0x17FF)
-    {
-        mappedAddr = chrBank[5] + (addr & 0x03FF);
-        return true;
-    }
-    else if (addr >= 0x1800 && addr <= 0x1BFF)
-    {
-        mappedAddr = chrBank[6] + (addr & 0x03FF);
-        return true;
-    }
-    else if (addr >= 0x1C00 && addr <= 0x1FFF)
-    {
-        mappedAddr = chrBank[7] + (addr & 0x03FF);
-        return true;
-    }
-
-    return false;
-}
-
-bool Mapper_004::ppuMapWrite(u16 addr, u32& mappedAddr)
-{
-    return false;
-}
-
 void Mapper_004::reset()
 {
     targetRegister = 0x00;
@@ -231,6 +182,7 @@ void Mapper_004::reset()
     irqEnable = false;
     irqUpdate = false;
     irqCounter = 0x0000;
+    setIRQ(false);
     irqReload = 0x0000;
 
     for (int i = 0; i < 4; i++)
@@ -248,16 +200,6 @@ void Mapper_004::reset()
     prgBank[3] = (prgBanks * 2 - 1) * 0x2000;
 }
 
-bool Mapper_004::irqState()
-{
-    return irqActive;
-}
-
-void Mapper_004::irqClear()
-{
-    irqActive = false;
-}
-
 void Mapper_004::scanline()
 {
     if (irqCounter == 0)
@@ -265,13 +207,17 @@ void Mapper_004::scanline()
     else
         irqCounter--;
 
+    // The IRQ is held until it is acknowledged.
     if (irqCounter == 0 && irqEnable)
+    {
         irqActive = true;
+        setIRQ(true);
+    }
 }
 
-Mirror Mapper_004::mirror()
+bool Mapper_004::scanlineIRQ()
 {
-    return mirrorMode;
+    return true;
 }
 
 //--------------//
@@ -334,6 +280,7 @@ void Mapper_004::loadSaveStateData(std::ifstream& state)
     state.read((char*)&irqActive, sizeof(bool));
     state.read((char*)&irqEnable, sizeof(bool));
     state.read((char*)&irqUpdate, sizeof(bool));
+    setIRQ(irqActive);
 
     // 4 bytes.
     state.read((char*)&irqCounter, sizeof(u16));
@@ -46,22 +46,6 @@ bool Mapper_066::cpuMapWrite(u16 addr, u32& mappedAddr, u8 data)
     return false;
 }
 
-bool Mapper_066::ppuMapRead(u16 addr, u32& mappedAddr)
-{
-    if (addr < 0x2000)
-    {
-        mappedAddr = chrBankSelect * 0x2000 + addr;
-        return true;
-    }
-    else
-        return false;
-}
-
-bool Mapper_066::ppuMapWrite(u16 addr, u32 &mappedAddr)
-{
-    return false;
-}
-
 void Mapper_066::reset()
 {
     chrBankSelect = 0;
@@ -20,8 +20,32 @@
 
 #include <ppu.h>
 
+// Language Headers.
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
 PPU::PPU()
 {
+	// Until a cartridge is inserted, any mapper may be used.
+	specialise<Mapper>();
+
+	// Every index must be within the screen palette, even before a frame is drawn.
+	std::memset(frameIndices, 0, sizeof(frameIndices));
+
+	// Power on with memory cleared, so the PPU always starts the same way.
+	std::memset(tblName, 0, sizeof(tblName));
+	std::memset(tblPattern, 0, sizeof(tblPattern));
+	std::memset(tblPalette, 0, sizeof(tblPalette));
+	std::memset(OAM, 0, sizeof(OAM));
+	std::memset(spriteScanline, 0, sizeof(spriteScanline));
+	spriteCount = 0;
+	std::memset(spriteShifterPatternLO, 0, sizeof(spriteShifterPatternLO));
+	std::memset(spriteShifterPatternHI, 0, sizeof(spriteShifterPatternHI));
+
 	// Initialise the screen palette.
 
 	palScreen[0x00] = {84, 84, 84, 255};
@@ -97,7 +121,8 @@ PPU::PPU()
 //	Interconnect Bus Communication	//
 //----------------------------------//
 
-u8 PPU::cpuRead(u16 addr)
+template <class MapperT>
+u8 PPU::cpuReadFor(u16 addr)
 {
 	u8 data = 0x00;
 
@@ -120,6 +145,7 @@ u8 PPU::cpuRead(u16 addr)
 		// Clear the VBlank flag and address latch.
 		status.vBlank = 0;
 		addressLatch = 0;
+		updateNMI();
 
 		break;
 
@@ -144,7 +170,7 @@ u8 PPU::cpuRead(u16 addr)
 	case 0x0007:
 		// Nametable reads are delayed by one cycle, so use a buffer.
 		data = ppuDataBuf;
-		ppuDataBuf = ppuRead(vramAddr.reg);
+		ppuDataBuf = ppuRead<MapperT>(vramAddr.reg);
 
 		// Reads in palette memory are not delayed.
 		if (vramAddr.reg >= 0x3F00)
@@ -158,13 +184,16 @@ u8 PPU::cpuRead(u16 addr)
 	return data;
 }
 
-void PPU::cpuWrite(u16 addr, u8 data)
+template <class MapperT>
+void PPU::cpuWriteFor(u16 addr, u8 data)
 {
 	switch (addr)
 	{
 		// Control.
 	case 0x0000:
 		control.reg = data;
+		// Enabling NMI during VBlank raises one immediately.
+		updateNMI();
 		t_vramAddr.nametableX = control.nametableX;
 		t_vramAddr.nametableY = control.nametableY;
 
@@ -229,7 +258,7 @@ void PPU::cpuWrite(u16 addr, u8 data)
 
 		// PPU Data.
 	case 0x0007:
-		ppuWrite(vramAddr.reg, data);
+		ppuWrite<MapperT>(vramAddr.reg, data);
 
 		// PPU writes auto increment the nametable address.
 		vramAddr.reg += (control.incMode ? 32 : 1);
@@ -241,6 +270,7 @@ void PPU::cpuWrite(u16 addr, u8 data)
 //	PPU Bus Communication	//
 //--------------------------//
 
+template <class MapperT>
 u8 PPU::ppuRead(u16 addr)
 {
 	u8 data = 0x00;
@@ -248,7 +278,7 @@ u8 PPU::ppuRead(u16 addr)
 	// Adjust address for the PPU.
 	addr &= 0x3FFF;
 
-	if (cart->ppuRead(addr, data))
+	if (cart->ppuRead<MapperT>(addr, data))
 	{
 	}
 	else if (addr >= 0x0000 && addr <= 0x1FFF)
@@ -258,7 +288,7 @@ u8 PPU::ppuRead(u16 addr)
 	{
 		addr &= 0x0FFF;
 
-		if (cart->mirror() == Mirror::VERTICAL)
+		if (cart->mirror<MapperT>() == Mirror::VERTICAL)
 		{
 			// Vertical.
 			if (addr >= 0x0000 && addr <= 0x03FF)
@@ -270,7 +300,7 @@ u8 PPU::ppuRead(u16 addr)
 			if (addr >= 0x0C00 && addr <= 0x0FFF)
 				data = tblName[1][addr & 0x03FF];
 		}
-		else if (cart->mirror() == Mirror::HORIZONTAL)
+		else if (cart->mirror<MapperT>() == Mirror::HORIZONTAL)
 		{
 			// Horizontal.
 			if (addr >= 0x0000 && addr <= 0x03FF)
@@ -301,12 +331,13 @@ u8 PPU::ppuRead(u16 addr)
 	return data;
 }
 
+template <class MapperT>
 void PPU::ppuWrite(u16 addr, u8 data)
 {
 	// Adjust address for the PPU.
 	addr &= 0x3FFF;
 
-	if (cart->ppuWrite(addr, data))
+	if (cart->ppuWrite<MapperT>(addr, data))
 	{
 	}
 	else if (addr >= 0x0000 && addr <= 0x1FFF)
@@ -314,7 +345,7 @@ void PPU::ppuWrite(u16 addr, u8 data)
 	else if (addr >= 0x2000 && addr <= 0x3EFF)
 	{
 		addr &= 0x0FFF;
-		if (cart->mirror() == Mirror::VERTICAL)
+		if (cart->mirror<MapperT>() == Mirror::VERTICAL)
 		{
 			// Vertical.
 			if (addr >= 0x0000 && addr <= 0x03FF)
@@ -326,7 +357,7 @@ void PPU::ppuWrite(u16 addr, u8 data)
 			if (addr >= 0x0C00 && addr <= 0x0FFF)
 				tblName[1][addr & 0x03FF] = data;
 		}
-		else if (cart->mirror() == Mirror::HORIZONTAL)
+		else if (cart->mirror<MapperT>() == Mirror::HORIZONTAL)
 		{
 			// Horizontal.
 			if (addr >= 0x0000 && addr <= 0x03FF)
@@ -359,24 +390,39 @@ void PPU::ppuWrite(u16 addr, u8 data)
 // Renderer Data    //
 //------------------//
 
+template <class MapperT>
 RGBAColor &PPU::getColorFromPalMemory(u8 palette, u8 pixel)
 {
 	// 0x3F00 is the start of palette memory.
 	// The palette pointer is shifted by 2 as they are 4 bytes long.
 	// The pixel index 0-3 is added to index into the palette.
 	// AND with 3F to get an index into the actual array.
-	return palScreen[ppuRead(0x3F00 + (palette << 2) + pixel) & 0x3F];
+	return palScreen[ppuRead<MapperT>(0x3F00 + (palette << 2) + pixel) & 0x3F];
 }
 
 //------------------//
 // PPU Interface	//
 //------------------//
 
-void PPU::connectCartridge(const std::shared_ptr<Cartridge> &cartridge)
+void PPU::connectCartridge(Cartridge *cartridge)
 {
 	this->cart = cartridge;
 }
 
+void PPU::connectInterrupts(InterruptLines *lines)
+{
+	this->interrupts = lines;
+}
+
+template <class MapperT>
+void PPU::specialise()
+{
+	specialised.cpuRead = &PPU::cpuReadFor<MapperT>;
+	specialised.cpuWrite = &PPU::cpuWriteFor<MapperT>;
+	specialised.clockCycle = &PPU::clockCycleFor<MapperT>;
+	specialised.run = &PPU::runFor<MapperT>;
+}
+
 void PPU::reset()
 {
 	// Reset the PPU to a known state.
@@ -403,9 +449,128 @@ void PPU::reset()
 	t_vramAddr.reg = 0x0000;
 	scanlineTrigger = false;
 	oddFrame = false;
+	updateNMI();
+}
+
+u32 PPU::cyclesUntilEvent(bool pollingStatus, bool irqEnabled)
+{
+	// Positions are counted in cycles from the start of the pre-render scanline.
+	constexpr u32 LINE = 341;
+	constexpr u32 FRAME = 262 * LINE;
+	u32 pos = (scanline + 1) * LINE + cycle;
+	bool rendering = mask.renderBG || mask.renderSprites;
+
+	// The sprite flags can change at any point during visible scanlines.
+	if (pollingStatus && rendering && scanline >= 0 && scanline < 240)
+		return 0;
+
+	u32 until = FRAME;
+	auto consider = [&](u32 event)
+	{
+		// Events before the current position happen next frame, which
+		// may be a cycle shorter if it is odd.
+		u32 distance = event >= pos ? event - pos : event + FRAME - pos - 1;
+		if (distance < until)
+			until = distance;
+	};
+
+	// VBlank starts, raising an NMI if enabled.
+	if (pollingStatus || control.enableNMI)
+		consider(242 * LINE + 1);
+
+	if (pollingStatus)
+	{
+		// The status flags are cleared on the pre-render scanline.
+		consider(1);
+		// The sprite flags can change from the first visible scanline.
+		if (rendering)
+			consider(LINE);
+	}
+
+	// The mapper is clocked at the end of every rendered scanline, which may raise an IRQ.
+	if (irqEnabled && rendering)
+	{
+		if (scanline < 240)
+			consider((scanline + 1) * LINE + 259);
+		if (scanline < 239)
+			consider((scanline + 2) * LINE + 259);
+		consider(259);
+	}
+
+	return until;
+}
+
+u32 PPU::cyclesUntilFrameEnd()
+{
+	// Positions are counted in cycles from the start of the pre-render scanline.
+	constexpr u32 LINE = 341;
+	constexpr u32 FRAME = 262 * LINE;
+	u32 pos = (scanline + 1) * LINE + cycle;
+
+	// Odd frames skip the first cycle of scanline 0 if rendering is enabled
+	// then, which may yet change.
+	if (oddFrame && pos <= LINE)
+		return FRAME - pos - 1;
+
+	return FRAME - pos;
+}
+
+u32 PPU::cyclesUntilVBlank()
+{
+	return cyclesUntilPosition(242 * 341 + 1);
+}
+
+u32 PPU::cyclesUntilScanlineClock()
+{
+	// The mapper is clocked on cycle 260 of every rendered scanline,
+	// i.e. after the PPU has processed cycle 259.
+	return cyclesUntilLineCycle(259, -1, 239);
+}
+
+u32 PPU::cyclesUntilSpriteEvaluation()
+{
+	// Sprites for the next scanline are evaluated on cycle 257 of every visible one.
+	return cyclesUntilLineCycle(257, 0, 239);
+}
+
+u32 PPU::cyclesUntilLineCycle(u16 lineCycle, s16 first, s16 last)
+{
+	// Positions are counted in cycles from the start of the pre-render scanline.
+	constexpr u32 LINE = 341;
+	u32 pos = (scanline + 1) * LINE + cycle;
+
+	// The first line at or after the position, wrapping to the next frame.
+	s32 line = pos <= lineCycle ? -1 : (s32)((pos - lineCycle + LINE - 1) / LINE) - 1;
+	if (line < first)
+		line = first;
+	if (line > last)
+		line = first;
+
+	return cyclesUntilPosition((line + 1) * LINE + lineCycle);
+}
+
+u32 PPU::cyclesUntilPosition(u32 position)
+{
+	// Positions are counted in cycles from the start of the pre-render scanline.
+	constexpr u32 LINE = 341;
+	constexpr u32 FRAME = 262 * LINE;
+	u32 pos = (scanline + 1) * LINE + cycle;
+
+	if (position >= pos)
+	{
+		// The first cycle of scanline 0 may be skipped on the way.
+		if (pos <= LINE && position > LINE)
+			return position - pos - 1;
+
+		return position - pos;
+	}
+
+	// The position is next frame, which may be a cycle shorter.
+	return position + FRAME - pos - 1;
 }
 
-void PPU::clockCycle()
+template <class MapperT>
+void PPU::clockCycleFor()
 {
 	if (scanline >= -1 && scanline < 240)
 	{
@@ -424,6 +589,7 @@ void PPU::clockCycle()
 			status.vBlank = 0;
 			status.spriteOverflow = 0;
 			status.spriteZeroHit = 0;
+			updateNMI();
 
 			// Clear Shifters
 			for (int i = 0; i < 8; i++)
@@ -442,39 +608,19 @@ void PPU::clockCycle()
 			switch ((cycle - 1) % 8)
 			{
 			case 0:
-				// Load the current BG tile pattern and attributes.
+				// Load the current BG tile pattern and attributes,
+				// then fetch the ID of the next.
 				scLoadBGShifters();
-
-				// Fetch ID of the next BG tile from the nametable address space,
-				// masking the 12 relevant bits.
-				bgNextTileID = ppuRead(0x2000 | (vramAddr.reg & 0x0FFF));
-
+				scFetchTileID<MapperT>();
 				break;
 			case 2:
-				// Fetch the attributes of the next BG tile.
-				// The attribute byte specifies 4 distinct palettes.
-				// 1 palette applies to 4 tiles, meaning BG tiles share palettes.
-
-				// Fetch from attribute memory, masking the 12 relevant bits.
-				bgNextTileAttrib = ppuRead(0x23C0 | (vramAddr.nametableY << 11) | (vramAddr.nametableX << 10) | ((vramAddr.coarseY >> 2) << 3) | (vramAddr.coarseX >> 2));
-
-				// Bottom 2 bits = the selected palettes.
-				if (vramAddr.coarseY & 0x02)
-					bgNextTileAttrib >>= 4;
-				if (vramAddr.coarseX & 0x02)
-					bgNextTileAttrib >>= 2;
-
-				bgNextTileAttrib &= 0x03;
-
+				scFetchTileAttrib<MapperT>();
 				break;
 			case 4:
-				// Fetch the LSB bit plane of the next BG tile from pattern memory.
-				bgNextTileLSB = ppuRead((control.patternBG << 12) + ((u16)bgNextTileID << 4) + (vramAddr.fineY) + 0);
+				scFetchTileLSB<MapperT>();
 				break;
 			case 6:
-				// Fetch the next background tile MSB bit plane from the pattern memory
-				// This is the same as above, but has a +8 offset to select the next bit plane
-				bgNextTileMSB = ppuRead((control.patternBG << 12) + ((u16)bgNextTileID << 4) + (vramAddr.fineY) + 8);
+				scFetchTileMSB<MapperT>();
 				break;
 			case 7:
 				// Increment the BG tile pointer horizontally.
@@ -493,7 +639,7 @@ void PPU::clockCycle()
 		}
 		// Read the next tile ID.
 		if (cycle == 338 || cycle == 340)
-			bgNextTileID = ppuRead(0x2000 | (vramAddr.reg & 0x0FFF));
+			scFetchTileID<MapperT>();
 
 		// End of VBlank, so prepare for rendering by resetting Y.
 		if (scanline == -1 && cycle >= 280 && cycle < 305)
@@ -506,140 +652,11 @@ void PPU::clockCycle()
 		// Perform all sprite evaluation in one hit.
 		// May impact compatibility somewhat, but greatly reduces the code needed.
 		if (cycle == 257 && scanline >= 0)
-		{
-			// We've reached the end of a visible scanline. It is now time to determine
-			// which sprites are visible on the next scanline, and preload this info
-			// into buffers that we can work with while the scanline scans the row.
-
-			// End of visible scanline, so decide the visible sprites for the next.
-
-			// Clear sprite memory.
-			std::memset(spriteScanline, 0xFF, 8 * sizeof(OAMEntry));
-
-			// Maximimum of 8 sprites per scanline.
-			spriteCount = 0;
-
-			// Reset the shifters.
-			for (u8 i = 0; i < 8; i++)
-			{
-				spriteShifterPatternLO[i] = 0;
-				spriteShifterPatternHI[i] = 0;
-			}
-
-			// Determine the visible sprites.
-			u8 iOAM = 0;
-			// Sprite 0 may not exist.
-			spriteZeroHitPossible = false;
-
-			while (iOAM < 64 && spriteCount < 9)
-			{
-				int16_t diff = ((int16_t)scanline - (int16_t)OAM[iOAM].y);
-
-				// If positive difference, scanline may fall within sprite.
-				if (diff >= 0 && diff < (control.spriteSize ? 16 : 8) && spriteCount < 8)
-				{
-					// Sprite is visible.
-					if (spriteCount < 8)
-					{
-						// Sprite zero?
-						if (iOAM == 0)
-							spriteZeroHitPossible = true;
-
-						memcpy(&spriteScanline[spriteCount], &OAM[iOAM], sizeof(OAMEntry));
-					}
-					spriteCount++;
-				}
-
-				iOAM++;
-			}
-
-			status.spriteOverflow = (spriteCount >= 8);
-
-			// The visible sprites are now known and ranked in priority order.
-		}
+			scEvaluateSprites();
 
+		// End of the entire scanline, so prepare the sprite shifters.
 		if (cycle == 340)
-		{
-			// End of the entire scanline, so prepare the sprite shifters..
-
-			for (u8 i = 0; i < spriteCount; i++)
-			{
-				// Extract the sprite's 8-bit row patterns.
-
-				u8 spritePatternBitsLO, spritePatternBitsHI;
-				u16 spritePatternAddrLO, spritePatternAddrHI;
-
-				// Determine the addresses containing the pattern data byte.
-				if (!control.spriteSize)
-				{
-					// 8x8 Sprite Mode - Pattern table is determined by the Control register.
-					if (!(spriteScanline[i].attribute & 0x80))
-					{
-						// Sprite is no V-flipped.
-						spritePatternAddrLO = (control.patternSprite << 12) | (spriteScanline[i].id << 4) | (scanline - spriteScanline[i].y);
-					}
-					else
-					{
-						// Sprite is V-flipped.
-						spritePatternAddrLO = (control.patternSprite << 12) | (spriteScanline[i].id << 4) | (7 - (scanline - spriteScanline[i].y));
-					}
-				}
-				else
-				{
-					// 8x16 Sprite Mode - Pattern table is determined by the sprite attribute.
-					if (!(spriteScanline[i].attribute & 0x80))
-					{
-						// Sprite is not v-flipped.
-						if (scanline - spriteScanline[i].y < 8)
-						{
-							// Reading the top half tile.
-							spritePatternAddrLO = ((spriteScanline[i].id & 0x01) << 12) | ((spriteScanline[i].id & 0xFE) << 4) | ((scanline - spriteScanline[i].y) & 0x07);
-						}
-						else
-						{
-							// Reading the bottom half tile.
-							spritePatternAddrLO =
-								((spriteScanline[i].id & 0x01) << 12) | (((spriteScanline[i].id & 0xFE) + 1) << 4) | ((scanline - spriteScanline[i].y) & 0x07);
-						}
-					}
-					else
-					{
-						// Sprite is V-flipped.
-						if (scanline - spriteScanline[i].y < 8)
-						{
-							// Read the top half tile.
-							spritePatternAddrLO =
-								((spriteScanline[i].id & 0x01) << 12) | (((spriteScanline[i].id & 0xFE) + 1) << 4) | (7 - (scanline - spriteScanline[i].y) & 0x07);
-						}
-						else
-						{
-							// Reading the bottom half tile.
-							spritePatternAddrLO =
-								((spriteScanline[i].id & 0x01) << 12) | ((spriteScanline[i].id & 0xFE) << 4) | (7 - (scanline - spriteScanline[i].y) & 0x07);
-						}
-					}
-				}
-
-				// The HI bit plane equivalent is offset from the LO bit plane by 8 bytes.
-				spritePatternAddrHI = spritePatternAddrLO + 8;
-
-				// Read the sprite patterns from the determined addresses.
-				spritePatternBitsLO = ppuRead(spritePatternAddrLO);
-				spritePatternBitsHI = ppuRead(spritePatternAddrHI);
-
-				// Flip pattern bytes if the sprite is H-flipped.
-				if (spriteScanline[i].attribute & 0x40)
-				{
-					// Flip Patterns Horizontally
-					spritePatternBitsLO = flipByte(spritePatternBitsLO);
-					spritePatternBitsHI = flipByte(spritePatternBitsHI);
-				}
-
-				// Load the pattern into the sprite shift registers, ready to commence rendering.
-				spriteShifterPatternLO[i] = spritePatternBitsLO;
-				spriteShifterPatternHI[i] = spritePatternBitsHI;
-			}
-		}
+			scLoadSpriteShifters<MapperT>();
 	}
 
 	if (scanline >= 241 && scanline < 261)
@@ -649,8 +666,7 @@ void PPU::clockCycle()
 			// End of frame, so begin VBlank.
 			status.vBlank = 1;
 			// Emit a VBlank NMI.
-			if (control.enableNMI)
-				nmi = true;
+			updateNMI();
 		}
 	}
 
@@ -781,17 +797,17 @@ void PPU::clockCycle()
 		}
 	}
 
-	// Render to the screen/render target.
+	// Render to the frame, which cycle 0 and the HBlank dots are outside of.
 	if (renderThisFrame)
-		if (scanline >= 0 && scanline < 240)
-			drawable->setPixel(cycle - 1, scanline, getColorFromPalMemory(palette, pixel));
+		if (scanline >= 0 && scanline < 240 && cycle >= 1 && cycle <= 256)
+			frameIndices[scanline][cycle - 1] = getColorIndex(palette, pixel) | getEmphasis();
 
 	// Progress the renderer.
 	cycle++;
 	if (mask.renderBG || mask.renderSprites)
 		if (cycle == 260 && scanline < 240)
 		{
-			cart->getMapper()->scanline();
+			cart->as<MapperT>().scanline();
 		}
 
 	if (cycle >= 341)
@@ -799,6 +815,9 @@ void PPU::clockCycle()
 		cycle = 0;
 		scanline++;
 
+		if (scanline == 240 && renderThisFrame)
+			presentFrame();
+
 		if (scanline >= 261)
 		{
 			scanline = -1;
@@ -808,6 +827,507 @@ void PPU::clockCycle()
 	}
 }
 
+template <class MapperT>
+void PPU::runFor(u32 cycles)
+{
+	while (cycles > 0)
+	{
+		// The CPU catches the PPU up before any access to it or the mapper, so no
+		// write can land part way through the cycles run here. Whole parts of
+		// visible scanlines can then be drawn at once, and the rest are clocked.
+		if (renderMode == Rendering::SCANLINE && scanline >= 0 && scanline < 240)
+		{
+			if (cycle == 0)
+			{
+				// The first cycle of odd frames is skipped if rendering.
+				u32 length = (scanline == 0 && oddFrame && (mask.renderBG || mask.renderSprites))
+					? VISIBLE_CYCLES - 1 : VISIBLE_CYCLES;
+
+				if (cycles >= length)
+				{
+					drawScanline<MapperT>();
+					cycles -= length;
+					continue;
+				}
+			}
+			else if (cycle == VISIBLE_CYCLES && cycles >= HBLANK_CYCLES)
+			{
+				finishScanline<MapperT>();
+				cycles -= HBLANK_CYCLES;
+				continue;
+			}
+		}
+
+		clockCycleFor<MapperT>();
+		cycles--;
+	}
+}
+
+//----------------------//
+// Scanline Renderer	//
+//----------------------//
+
+template <class MapperT>
+void PPU::drawScanline()
+{
+	// Nothing changes the PPU's registers part way through the line.
+	const bool renderBG = mask.renderBG;
+	const bool renderSprites = mask.renderSprites;
+
+	//------------------//
+	// BG Rendering.	//
+	//------------------//
+
+	// The 2-bit pixel and palette of the background, from the first tile
+	// prefetched on the previous line, which fine X scrolls the screen into.
+	u8 bgLine[34 * 8];
+	u8 bgPalLine[34 * 8];
+
+	// The first two tiles are already in the shifters.
+	if (renderBG)
+	{
+		ChrRow::decode(bgShifterPatternLO >> 8, bgShifterPatternHI >> 8, &bgLine[0]);
+		ChrRow::decode(bgShifterPatternLO & 0xFF, bgShifterPatternHI & 0xFF, &bgLine[8]);
+		ChrRow::decode(bgShifterAttribLO >> 8, bgShifterAttribHI >> 8, &bgPalLine[0]);
+		ChrRow::decode(bgShifterAttribLO & 0xFF, bgShifterAttribHI & 0xFF, &bgPalLine[8]);
+	}
+
+	// The shifters are run to be left as clocking them would, but the pixels
+	// of each tile fetched are copied from its decoded row. Cycle 0 does
+	// nothing, and the shifters only shift from cycle 2.
+	for (u8 tile = 0; tile < 32; tile++)
+	{
+		if (tile > 0)
+		{
+			if (renderBG)
+			{
+				bgShifterPatternLO <<= 1;
+				bgShifterPatternHI <<= 1;
+				bgShifterAttribLO <<= 1;
+				bgShifterAttribHI <<= 1;
+			}
+
+			scLoadBGShifters();
+			scFetchTileID<MapperT>();
+		}
+
+		if (renderBG)
+		{
+			bgShifterPatternLO <<= 7;
+			bgShifterPatternHI <<= 7;
+			bgShifterAttribLO <<= 7;
+			bgShifterAttribHI <<= 7;
+		}
+
+		scFetchTileAttrib<MapperT>();
+		const ChrRow *row = scFetchTileRow<MapperT>();
+		scIncrementScrollX();
+
+		if (renderBG)
+		{
+			u8 *pixels = &bgLine[(tile + 2) * 8];
+			if (row != nullptr)
+				std::memcpy(pixels, row->pixels, 8);
+			else
+				ChrRow::decode(bgNextTileLSB, bgNextTileMSB, pixels);
+
+			std::memset(&bgPalLine[(tile + 2) * 8], bgNextTileAttrib, 8);
+		}
+	}
+
+	// End of the visible scanline.
+	scIncrementScrollY();
+
+	// The pixel and palette at each X.
+	u8 *bgPixel = &bgLine[fineX];
+	u8 *bgPal = &bgPalLine[fineX];
+
+	if (!renderBG)
+	{
+		std::memset(bgPixel, 0, 256);
+		std::memset(bgPal, 0, 256);
+	}
+	else if (!mask.render_background_left)
+	{
+		std::memset(bgPixel, 0, 8);
+		std::memset(bgPal, 0, 8);
+	}
+
+	//----------------------//
+	// Sprite Rendering.	//
+	//----------------------//
+
+	// The palette entry of the first opaque sprite pixel at each X, or 0 if
+	// there is none, and masks of whether it is in front of the background
+	// and belongs to sprite zero.
+	u8 fgEntry[256] = {};
+	u8 fgFront[256] = {};
+	u8 fgZero[256] = {};
+
+	if (renderSprites)
+	{
+		// Lower sprites are drawn over higher ones, so have priority.
+		for (s16 i = spriteCount - 1; i >= 0; i--)
+		{
+			const OAMEntry &sprite = spriteScanline[i];
+
+			u8 pixels[8];
+			ChrRow::decode(spriteShifterPatternLO[i], spriteShifterPatternHI[i], pixels);
+
+			for (u8 bit = 0; bit < 8 && sprite.x + bit < 256; bit++)
+			{
+				u8 pixel = pixels[bit];
+				if (pixel != 0)
+				{
+					u16 x = sprite.x + bit;
+					fgEntry[x] = (((sprite.attribute & 0x03) + 0x04) << 2) | pixel;
+					fgFront[x] = (sprite.attribute & 0x20) == 0 ? 0xFF : 0x00;
+					fgZero[x] = i == 0 ? 0xFF : 0x00;
+				}
+			}
+
+			// The sprite counts down to its X, then shifts out its row, over
+			// the 255 cycles the shifters are updated on up to now.
+			if (sprite.x >= 255)
+				spriteScanline[i].x -= 255;
+			else
+			{
+				u8 shift = 255 - sprite.x;
+				spriteShifterPatternLO[i] = shift < 8 ? spriteShifterPatternLO[i] << shift : 0;
+				spriteShifterPatternHI[i] = shift < 8 ? spriteShifterPatternHI[i] << shift : 0;
+				spriteScanline[i].x = 0;
+			}
+		}
+
+		if (!mask.renderBGLeft)
+			std::memset(fgEntry, 0, 8);
+	}
+
+	// The last pixel decides whether sprite zero was being rendered.
+	if (renderSprites)
+		spriteZeroBeingRendered = fgEntry[255] != 0 && fgZero[255];
+
+	//--------------//
+	// Composition	//
+	//--------------//
+
+	// Palette memory can't change either, so its colours are looked up once.
+	u8 colours[32];
+	for (u8 i = 0; i < 32; i++)
+		colours[i] = getColorIndex(i >> 2, i & 0x03);
+
+	// Sprite zero can't hit at the left edge if it is clipped.
+	if (!(mask.render_background_left | mask.renderBGLeft))
+		std::memset(fgZero, 0, 8);
+
+	u8 line[256];
+	if (composeScanline(bgPixel, bgPal, fgEntry, fgFront, fgZero, colours, line))
+		if (spriteZeroHitPossible && renderBG && renderSprites)
+			status.spriteZeroHit = 1;
+
+	// The emphasis bits can't change during the scanline either.
+	if (renderThisFrame)
+	{
+		u16 emphasis = getEmphasis();
+		for (u16 x = 0; x < 256; x++)
+			frameIndices[scanline][x] = line[x] | emphasis;
+	}
+
+	cycle = VISIBLE_CYCLES;
+}
+
+template <class MapperT>
+void PPU::finishScanline()
+{
+	const bool renderBG = mask.renderBG;
+	const bool renderSprites = mask.renderSprites;
+
+	// Cycle 257 loads the last tile fetched, then the next line's sprites are
+	// found. Their shifters are empty until cycle 340, so draw nothing before.
+	if (renderBG)
+	{
+		bgShifterPatternLO <<= 1;
+		bgShifterPatternHI <<= 1;
+		bgShifterAttribLO <<= 1;
+		bgShifterAttribHI <<= 1;
+	}
+
+	scLoadBGShifters();
+	scFetchTileID<MapperT>();
+	scLoadBGShifters();
+	scTransferAddressX();
+	scEvaluateSprites();
+
+	if (renderSprites)
+		spriteZeroBeingRendered = false;
+
+	// The mapper is clocked on cycle 260.
+	if (mask.renderBG || mask.renderSprites)
+		cart->as<MapperT>().scanline();
+
+	// Cycles 321 - 336 fetch the first two tiles of the next line, loading
+	// the BG shifters, which shift on every cycle, at the start of each.
+	for (u8 tile = 0; tile < 2; tile++)
+	{
+		if (renderBG)
+		{
+			bgShifterPatternLO <<= 1;
+			bgShifterPatternHI <<= 1;
+			bgShifterAttribLO <<= 1;
+			bgShifterAttribHI <<= 1;
+		}
+
+		scLoadBGShifters();
+		scFetchTileID<MapperT>();
+		scFetchTileAttrib<MapperT>();
+		scFetchTileLSB<MapperT>();
+		scFetchTileMSB<MapperT>();
+
+		if (renderBG)
+		{
+			bgShifterPatternLO <<= 7;
+			bgShifterPatternHI <<= 7;
+			bgShifterAttribLO <<= 7;
+			bgShifterAttribHI <<= 7;
+		}
+
+		scIncrementScrollX();
+	}
+
+	// Cycle 337 loads the second, and the third tile's ID is read on cycles
+	// 337, 338 and 340, from the same address.
+	if (renderBG)
+	{
+		bgShifterPatternLO <<= 1;
+		bgShifterPatternHI <<= 1;
+		bgShifterAttribLO <<= 1;
+		bgShifterAttribHI <<= 1;
+	}
+
+	scLoadBGShifters();
+	scFetchTileID<MapperT>();
+
+	// Cycle 340 loads the sprites, and draws the first of any at X 0.
+	scLoadSpriteShifters<MapperT>();
+
+	if (renderSprites)
+	{
+		spriteZeroBeingRendered = false;
+		for (u8 i = 0; i < spriteCount; i++)
+		{
+			if (spriteScanline[i].x == 0 && ((spriteShifterPatternLO[i] | spriteShifterPatternHI[i]) & 0x80))
+			{
+				spriteZeroBeingRendered = i == 0;
+				break;
+			}
+		}
+	}
+
+	cycle = 0;
+	scanline++;
+
+	if (scanline == 240 && renderThisFrame)
+		presentFrame();
+}
+
+//----------------------//
+// Scanline Composition	//
+//----------------------//
+
+bool PPU::composeScanline(const u8 *bgPixel, const u8 *bgPal, const u8 *fgEntry, const u8 *fgFront, const u8 *fgZero, const u8 *colours, u8 *line)
+{
+	u16 x = 0;
+	bool hit = false;
+
+	// The same as the loop below, a vector of pixels at a time. Transparent BG
+	// pixels have entry 0, the backdrop, and sprite pixels are chosen where
+	// opaque and either in front or over a transparent BG pixel.
+#if defined(__AVX2__)
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i coloursLO = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&colours[0])));
+	const __m256i coloursHI = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&colours[16])));
+	__m256i hits = zero;
+
+	for (; x < 256; x += 32)
+	{
+		__m256i pixel = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&bgPixel[x]));
+		__m256i palette = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&bgPal[x]));
+		__m256i fg = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&fgEntry[x]));
+		__m256i front = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&fgFront[x]));
+		__m256i zeroMask = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&fgZero[x]));
+
+		// Palettes are 2 bits, so shifting by 16-bit lanes can't carry between pixels.
+		__m256i bgClear = _mm256_cmpeq_epi8(pixel, zero);
+		__m256i bg = _mm256_andnot_si256(bgClear, _mm256_or_si256(_mm256_slli_epi16(palette, 2), pixel));
+		__m256i fgClear = _mm256_cmpeq_epi8(fg, zero);
+
+		__m256i useFG = _mm256_andnot_si256(fgClear, _mm256_or_si256(bgClear, front));
+		__m256i entry = _mm256_blendv_epi8(bg, fg, useFG);
+		hits = _mm256_or_si256(hits, _mm256_andnot_si256(_mm256_or_si256(bgClear, fgClear), zeroMask));
+
+		// Shuffles look up the 16 entries of one half of the palette each.
+		__m256i upper = _mm256_cmpeq_epi8(_mm256_and_si256(entry, _mm256_set1_epi8(0x10)), _mm256_set1_epi8(0x10));
+		__m256i colour = _mm256_blendv_epi8(_mm256_shuffle_epi8(coloursLO, entry), _mm256_shuffle_epi8(coloursHI, entry), upper);
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(&line[x]), colour);
+	}
+
+	hit = _mm256_movemask_epi8(hits) != 0;
+#elif defined(__SSE2__) || defined(_M_X64)
+	const __m128i zero = _mm_setzero_si128();
+	__m128i hits = zero;
+
+	for (; x < 256; x += 16)
+	{
+		__m128i pixel = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&bgPixel[x]));
+		__m128i palette = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&bgPal[x]));
+		__m128i fg = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&fgEntry[x]));
+		__m128i front = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&fgFront[x]));
+		__m128i zeroMask = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&fgZero[x]));
+
+		// Palettes are 2 bits, so shifting by 16-bit lanes can't carry between pixels.
+		__m128i bgClear = _mm_cmpeq_epi8(pixel, zero);
+		__m128i bg = _mm_andnot_si128(bgClear, _mm_or_si128(_mm_slli_epi16(palette, 2), pixel));
+		__m128i fgClear = _mm_cmpeq_epi8(fg, zero);
+
+		__m128i useFG = _mm_andnot_si128(fgClear, _mm_or_si128(bgClear, front));
+		__m128i entry = _mm_or_si128(_mm_and_si128(useFG, fg), _mm_andnot_si128(useFG, bg));
+		hits = _mm_or_si128(hits, _mm_andnot_si128(_mm_or_si128(bgClear, fgClear), zeroMask));
+
+#if defined(__SSSE3__)
+		// Shuffles look up the 16 entries of one half of the palette each.
+		__m128i upper = _mm_cmpeq_epi8(_mm_and_si128(entry, _mm_set1_epi8(0x10)), _mm_set1_epi8(0x10));
+		__m128i colourLO = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&colours[0])), entry);
+		__m128i colourHI = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&colours[16])), entry);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(&line[x]), _mm_or_si128(_mm_and_si128(upper, colourHI), _mm_andnot_si128(upper, colourLO)));
+#else
+		// Without a byte shuffle, the colours are looked up one at a time.
+		u8 entries[16];
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(entries), entry);
+		for (u8 i = 0; i < 16; i++)
+			line[x + i] = colours[entries[i]];
+#endif
+	}
+
+	hit = _mm_movemask_epi8(hits) != 0;
+#endif
+
+	for (; x < 256; x++)
+	{
+		u8 bg = bgPixel[x] != 0 ? (bgPal[x] << 2) | bgPixel[x] : 0x00;
+		u8 fg = fgEntry[x];
+
+		if (fg != 0 && (bg == 0 || fgFront[x]))
+			line[x] = colours[fg];
+		else
+			line[x] = colours[bg];
+
+		// Sprite Zero detection.
+		if (bg != 0 && fg != 0 && fgZero[x])
+			hit = true;
+	}
+
+	return hit;
+}
+
+//------------------//
+// Frame Output		//
+//------------------//
+
+//------------------------------------------------------------------------------//
+// The conversion to RGBA is compiled for AVX2 whatever the core is built for,  //
+// and used if the host supports it, which is checked the first time it runs.   //
+// Without gathers, a table lookup per pixel is as fast as any SSE version.     //
+//------------------------------------------------------------------------------//
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define OCRNES_CONVERT_AVX2
+#define OCRNES_TARGET(isa) __attribute__((target(isa)))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define OCRNES_CONVERT_AVX2
+#define OCRNES_TARGET(isa)
+#endif
+
+/**
+ * @brief Converts pixels to RGBA, one at a time.
+ *
+ * @param indices The pixels, as recorded in frameIndices.
+ * @param colours The RGBA colours.
+ * @param palette The screen palette.
+ * @param count The number of pixels.
+ */
+static void convertScalar(const u16 *indices, u32 *colours, const RGBAColor *palette, u32 count)
+{
+	for (u32 i = 0; i < count; i++)
+		colours[i] = palette[indices[i] & 0x3F].rgba;
+}
+
+#ifdef OCRNES_CONVERT_AVX2
+
+/**
+ * @brief Converts pixels to RGBA, gathering 8 pixels' colours at a time.
+ */
+OCRNES_TARGET("avx2")
+static void convertAVX2(const u16 *indices, u32 *colours, const RGBAColor *palette, u32 count)
+{
+	const int *table = reinterpret_cast<const int *>(palette);
+	const __m256i indexMask = _mm256_set1_epi32(0x3F);
+	u32 i = 0;
+
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256i index = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&indices[i])));
+		index = _mm256_and_si256(index, indexMask);
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(&colours[i]), _mm256_i32gather_epi32(table, index, sizeof(RGBAColor)));
+	}
+
+	convertScalar(&indices[i], &colours[i], palette, count - i);
+}
+
+/**
+ * @brief Whether the host supports AVX2.
+ */
+static bool hostSupportsAVX2()
+{
+#if defined(__GNUC__)
+	return __builtin_cpu_supports("avx2");
+#else
+	// AVX2 also needs the OS to save the upper halves of the registers.
+	int info[4];
+	__cpuid(info, 1);
+	if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x06) != 0x06)
+		return false;
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#endif
+}
+
+#endif
+
+void PPU::presentFrame()
+{
+	typedef void (*ConvertFunction)(const u16 *indices, u32 *colours, const RGBAColor *palette, u32 count);
+
+#ifdef OCRNES_CONVERT_AVX2
+	static const ConvertFunction convert = hostSupportsAVX2() ? &convertAVX2 : &convertScalar;
+#else
+	static const ConvertFunction convert = &convertScalar;
+#endif
+
+	convert(&frameIndices[0][0], &frameColours[0][0].rgba, palScreen, 256 * 240);
+
+	// Only rows which have changed need to be redrawn, other than the first frame.
+	for (int y = 0; y < 240; y++)
+	{
+		dirtyRows[y] = !presentedFrame || std::memcmp(frameIndices[y], presentedIndices[y], sizeof(frameIndices[y])) != 0;
+		if (dirtyRows[y])
+			std::memcpy(presentedIndices[y], frameIndices[y], sizeof(frameIndices[y]));
+	}
+
+	presentedFrame = true;
+	drawable->submitFrame(&frameColours[0][0], dirtyRows);
+}
+
 //------------------//
 // Scanline Actions	//
 //------------------//
@@ -916,14 +1436,224 @@ void PPU::scUpdateShifters()
 	}
 };
 
+template <class MapperT>
+void PPU::scFetchTileID()
+{
+	// Fetch ID of the next BG tile from the nametable address space,
+	// masking the 12 relevant bits.
+	bgNextTileID = ppuRead<MapperT>(0x2000 | (vramAddr.reg & 0x0FFF));
+}
+
+template <class MapperT>
+void PPU::scFetchTileAttrib()
+{
+	// Fetch the attributes of the next BG tile.
+	// The attribute byte specifies 4 distinct palettes.
+	// 1 palette applies to 4 tiles, meaning BG tiles share palettes.
+
+	// Fetch from attribute memory, masking the 12 relevant bits.
+	bgNextTileAttrib = ppuRead<MapperT>(0x23C0 | (vramAddr.nametableY << 11) | (vramAddr.nametableX << 10) | ((vramAddr.coarseY >> 2) << 3) | (vramAddr.coarseX >> 2));
+
+	// Bottom 2 bits = the selected palettes.
+	if (vramAddr.coarseY & 0x02)
+		bgNextTileAttrib >>= 4;
+	if (vramAddr.coarseX & 0x02)
+		bgNextTileAttrib >>= 2;
+
+	bgNextTileAttrib &= 0x03;
+}
+
+template <class MapperT>
+void PPU::scFetchTileLSB()
+{
+	// Fetch the LSB bit plane of the next BG tile from pattern memory.
+	bgNextTileLSB = ppuRead<MapperT>((control.patternBG << 12) + ((u16)bgNextTileID << 4) + (vramAddr.fineY) + 0);
+}
+
+template <class MapperT>
+void PPU::scFetchTileMSB()
+{
+	// Fetch the next background tile MSB bit plane from the pattern memory
+	// This is the same as above, but has a +8 offset to select the next bit plane
+	bgNextTileMSB = ppuRead<MapperT>((control.patternBG << 12) + ((u16)bgNextTileID << 4) + (vramAddr.fineY) + 8);
+}
+
+template <class MapperT>
+const ChrRow *PPU::scFetchTileRow()
+{
+	// Fetch both bit planes of the next BG tile's row at once, decoded,
+	// unless the cartridge doesn't map pattern memory.
+	const ChrRow *row = cart->ppuReadRow<MapperT>((control.patternBG << 12) + ((u16)bgNextTileID << 4) + (vramAddr.fineY));
+
+	if (row != nullptr)
+	{
+		bgNextTileLSB = row->lo;
+		bgNextTileMSB = row->hi;
+	}
+	else
+	{
+		scFetchTileLSB<MapperT>();
+		scFetchTileMSB<MapperT>();
+	}
+
+	return row;
+}
+
+void PPU::scEvaluateSprites()
+{
+	// We've reached the end of a visible scanline. It is now time to determine
+	// which sprites are visible on the next scanline, and preload this info
+	// into buffers that we can work with while the scanline scans the row.
+
+	// End of visible scanline, so decide the visible sprites for the next.
+
+	// Clear sprite memory.
+	std::memset(spriteScanline, 0xFF, 8 * sizeof(OAMEntry));
+
+	// Maximimum of 8 sprites per scanline.
+	spriteCount = 0;
+
+	// Reset the shifters.
+	for (u8 i = 0; i < 8; i++)
+	{
+		spriteShifterPatternLO[i] = 0;
+		spriteShifterPatternHI[i] = 0;
+	}
+
+	// Determine the visible sprites.
+	u8 iOAM = 0;
+	// Sprite 0 may not exist.
+	spriteZeroHitPossible = false;
+
+	while (iOAM < 64 && spriteCount < 9)
+	{
+		int16_t diff = ((int16_t)scanline - (int16_t)OAM[iOAM].y);
+
+		// If positive difference, scanline may fall within sprite.
+		if (diff >= 0 && diff < (control.spriteSize ? 16 : 8) && spriteCount < 8)
+		{
+			// Sprite is visible.
+			if (spriteCount < 8)
+			{
+				// Sprite zero?
+				if (iOAM == 0)
+					spriteZeroHitPossible = true;
+
+				memcpy(&spriteScanline[spriteCount], &OAM[iOAM], sizeof(OAMEntry));
+			}
+			spriteCount++;
+		}
+
+		iOAM++;
+	}
+
+	status.spriteOverflow = (spriteCount >= 8);
+
+	// The visible sprites are now known and ranked in priority order.
+}
+
+template <class MapperT>
+void PPU::scLoadSpriteShifters()
+{
+	// End of the entire scanline, so prepare the sprite shifters..
+
+	for (u8 i = 0; i < spriteCount; i++)
+	{
+		// Extract the sprite's 8-bit row patterns.
+
+		u8 spritePatternBitsLO, spritePatternBitsHI;
+		u16 spritePatternAddrLO, spritePatternAddrHI;
+
+		// Determine the addresses containing the pattern data byte.
+		if (!control.spriteSize)
+		{
+			// 8x8 Sprite Mode - Pattern table is determined by the Control register.
+			if (!(spriteScanline[i].attribute & 0x80))
+			{
+				// Sprite is no V-flipped.
+				spritePatternAddrLO = (control.patternSprite << 12) | (spriteScanline[i].id << 4) | (scanline - spriteScanline[i].y);
+			}
+			else
+			{
+				// Sprite is V-flipped.
+				spritePatternAddrLO = (control.patternSprite << 12) | (spriteScanline[i].id << 4) | (7 - (scanline - spriteScanline[i].y));
+			}
+		}
+		else
+		{
+			// 8x16 Sprite Mode - Pattern table is determined by the sprite attribute.
+			if (!(spriteScanline[i].attribute & 0x80))
+			{
+				// Sprite is not v-flipped.
+				if (scanline - spriteScanline[i].y < 8)
+				{
+					// Reading the top half tile.
+					spritePatternAddrLO = ((spriteScanline[i].id & 0x01) << 12) | ((spriteScanline[i].id & 0xFE) << 4) | ((scanline - spriteScanline[i].y) & 0x07);
+				}
+				else
+				{
+					// Reading the bottom half tile.
+					spritePatternAddrLO =
+						((spriteScanline[i].id & 0x01) << 12) | (((spriteScanline[i].id & 0xFE) + 1) << 4) | ((scanline - spriteScanline[i].y) & 0x07);
+				}
+			}
+			else
+			{
+				// Sprite is V-flipped.
+				if (scanline - spriteScanline[i].y < 8)
+				{
+					// Read the top half tile.
+					spritePatternAddrLO =
+						((spriteScanline[i].id & 0x01) << 12) | (((spriteScanline[i].id & 0xFE) + 1) << 4) | (7 - (scanline - spriteScanline[i].y) & 0x07);
+				}
+				else
+				{
+					// Reading the bottom half tile.
+					spritePatternAddrLO =
+						((spriteScanline[i].id & 0x01) << 12) | ((spriteScanline[i].id & 0xFE) << 4) | (7 - (scanline - spriteScanline[i].y) & 0x07);
+				}
+			}
+		}
+
+		// The HI bit plane equivalent is offset from the LO bit plane by 8 bytes.
+		spritePatternAddrHI = spritePatternAddrLO + 8;
+
+		// Read the sprite patterns from the determined addresses, both at once
+		// and already flipped if the cartridge maps pattern memory.
+		const ChrRow *row = cart->ppuReadRow<MapperT>(spritePatternAddrLO);
+		if (row != nullptr)
+		{
+			bool flip = spriteScanline[i].attribute & 0x40;
+			spritePatternBitsLO = flip ? row->loFlipped : row->lo;
+			spritePatternBitsHI = flip ? row->hiFlipped : row->hi;
+		}
+		else
+		{
+			spritePatternBitsLO = ppuRead<MapperT>(spritePatternAddrLO);
+			spritePatternBitsHI = ppuRead<MapperT>(spritePatternAddrHI);
+
+			// Flip pattern bytes if the sprite is H-flipped.
+			if (spriteScanline[i].attribute & 0x40)
+			{
+				// Flip Patterns Horizontally
+				spritePatternBitsLO = flipByte(spritePatternBitsLO);
+				spritePatternBitsHI = flipByte(spritePatternBitsHI);
+			}
+		}
+
+		// Load the pattern into the sprite shift registers, ready to commence rendering.
+		spriteShifterPatternLO[i] = spritePatternBitsLO;
+		spriteShifterPatternHI[i] = spritePatternBitsHI;
+	}
+}
+
 //--------------//
 //	SaveState	//
 //--------------//
 
 void PPU::writeSaveStateData(std::ofstream &state)
 {
-	// 3 bytes.
-	state.write((char *)&nmi, sizeof(bool));
+	// 2 bytes.
 	state.write((char *)&scanlineTrigger, sizeof(bool));
 	state.write((char *)&frameComplete, sizeof(bool));
 
@@ -978,8 +1708,7 @@ void PPU::writeSaveStateData(std::ofstream &state)
 
 void PPU::loadSaveStateData(std::ifstream &state)
 {
-	// 3 bytes.
-	state.read((char *)&nmi, sizeof(bool));
+	// 2 bytes.
 	state.read((char *)&scanlineTrigger, sizeof(bool));
 	state.read((char *)&frameComplete, sizeof(bool));
 
@@ -1031,3 +1760,13 @@ void PPU::loadSaveStateData(std::ifstream &state)
 	state.read((char *)&spriteZeroHitPossible, sizeof(bool));
 	state.read((char *)&spriteZeroBeingRendered, sizeof(bool));
 }
+
+//------------------//
+// Specialisation	//
+//------------------//
+
+// Every mapper the cartridge can load, and Mapper itself for any of them.
+template void PPU::specialise<Mapper>();
+#define MAPPER(id, MapperT) template void PPU::specialise<MapperT>();
+OCRNES_MAPPER_TABLE(MAPPER)
+#undef MAPPER
@@ -0,0 +1,194 @@
+##################################################################################
+##                                                                              ##
+##  OCR-NES - An NES Emulator written for the OCR A-Level                       ##
+##  Computer Science Programming Project.                                       ##
+##                                                                              ##
+##  Copyright (C) 2021 - 2022 Conaer Macpherson                                 ##
+##                                                                              ##
+##################################################################################
+
+# File: generate.py
+# Author: Conaer Macpherson (Candidate No. 6189)
+# Brief: Builds the test ROMs ocrnes-verify is run over from test.s.
+# Version: 0.1
+# Date: 2022-03-22
+#
+# Copyright (c) 2021 - 2022
+#
+# The ROMs are checked in, so this is only needed after changing test.s:
+#     python3 generate.py
+#
+# test.s renders a scrolling screen with sprites and a sprite zero split, and
+# runs the copy, countdown and polling loops the CPU fuses and skips, along with
+# code copied to RAM which rewrites itself. It is built for NROM, and for MMC3,
+# whose scanline IRQ it also uses.
+
+import os
+import random
+import struct
+
+#------------------#
+# Assembler        #
+#------------------#
+
+# The opcode of each instruction in each addressing mode test.s uses.
+OPCODES = {
+    'LDA': { 'imm': 0xA9, 'zp': 0xA5, 'zpx': 0xB5, 'abs': 0xAD, 'abx': 0xBD, 'aby': 0xB9, 'izx': 0xA1, 'izy': 0xB1 },
+    'LDX': { 'imm': 0xA2, 'zp': 0xA6, 'zpy': 0xB6, 'abs': 0xAE, 'aby': 0xBE },
+    'LDY': { 'imm': 0xA0, 'zp': 0xA4, 'zpx': 0xB4, 'abs': 0xAC, 'abx': 0xBC },
+    'STA': { 'zp': 0x85, 'zpx': 0x95, 'abs': 0x8D, 'abx': 0x9D, 'aby': 0x99, 'izx': 0x81, 'izy': 0x91 },
+    'STX': { 'zp': 0x86, 'abs': 0x8E },
+    'STY': { 'zp': 0x84, 'abs': 0x8C },
+    'ADC': { 'imm': 0x69, 'zp': 0x65, 'abs': 0x6D },
+    'SBC': { 'imm': 0xE9, 'zp': 0xE5 },
+    'AND': { 'imm': 0x29, 'zp': 0x25 },
+    'ORA': { 'imm': 0x09, 'zp': 0x05 },
+    'EOR': { 'imm': 0x49, 'zp': 0x45 },
+    'CMP': { 'imm': 0xC9, 'zp': 0xC5, 'abs': 0xCD },
+    'CPX': { 'imm': 0xE0 },
+    'CPY': { 'imm': 0xC0 },
+    'INC': { 'zp': 0xE6, 'abs': 0xEE, 'abx': 0xFE },
+    'DEC': { 'zp': 0xC6, 'abs': 0xCE },
+    'ASL': { 'acc': 0x0A, 'zp': 0x06 },
+    'LSR': { 'acc': 0x4A, 'zp': 0x46 },
+    'ROL': { 'acc': 0x2A, 'zp': 0x26 },
+    'ROR': { 'acc': 0x6A, 'zp': 0x66 },
+    'BIT': { 'zp': 0x24, 'abs': 0x2C },
+    'JMP': { 'abs': 0x4C, 'ind': 0x6C },
+    'JSR': { 'abs': 0x20 },
+    'BPL': { 'rel': 0x10 }, 'BMI': { 'rel': 0x30 }, 'BVC': { 'rel': 0x50 }, 'BVS': { 'rel': 0x70 },
+    'BCC': { 'rel': 0x90 }, 'BCS': { 'rel': 0xB0 }, 'BNE': { 'rel': 0xD0 }, 'BEQ': { 'rel': 0xF0 },
+}
+
+IMPLIED = {
+    'BRK': 0x00, 'RTI': 0x40, 'RTS': 0x60, 'PHP': 0x08, 'PLP': 0x28, 'PHA': 0x48, 'PLA': 0x68,
+    'DEY': 0x88, 'TAY': 0xA8, 'INY': 0xC8, 'INX': 0xE8, 'CLC': 0x18, 'SEC': 0x38, 'CLI': 0x58,
+    'SEI': 0x78, 'TYA': 0x98, 'CLV': 0xB8, 'CLD': 0xD8, 'SED': 0xF8, 'TXA': 0x8A, 'TXS': 0x9A,
+    'TAX': 0xAA, 'TSX': 0xBA, 'DEX': 0xCA, 'NOP': 0xEA,
+}
+
+def value(text, labels, final):
+    """Evaluates an operand: $hex, decimal, a label, <low or >high byte, or a sum."""
+    text = text.strip()
+    if text.startswith('<'):
+        return value(text[1:], labels, final) & 0xFF
+    if text.startswith('>'):
+        return value(text[1:], labels, final) >> 8
+    if '+' in text:
+        a, b = text.split('+', 1)
+        return value(a, labels, final) + value(b, labels, final)
+    if text.startswith('$'):
+        return int(text[1:], 16)
+    if text.isdigit():
+        return int(text)
+
+    # Labels not yet seen in the first pass are assumed to be absolute.
+    return labels[text] if final else labels.get(text, 0x8000)
+
+def assemble(source, origin):
+    """Assembles source at an origin, in two passes to resolve forward labels.
+    A ! before an operand forces absolute addressing for addresses in the zero page."""
+    lines = [line.split(';')[0].strip() for line in source.split('\n')]
+
+    def encode(final, labels):
+        pc = origin
+        out = bytearray()
+
+        for line in lines:
+            if not line:
+                continue
+            if line.endswith(':'):
+                labels[line[:-1]] = pc
+                continue
+
+            parts = line.split(None, 1)
+            op = parts[0].upper()
+            arg = parts[1].strip() if len(parts) > 1 else ''
+
+            if op == '.ORG':
+                target = value(arg, labels, final)
+                out += bytes(target - pc)
+                pc = target
+                continue
+
+            if op in IMPLIED:
+                code = bytes([IMPLIED[op]])
+            elif arg.upper() == 'A' or (arg == '' and 'acc' in OPCODES[op]):
+                code = bytes([OPCODES[op]['acc']])
+            elif 'rel' in OPCODES[op]:
+                offset = value(arg, labels, final) - (pc + 2) if final else 0
+                assert -128 <= offset <= 127, line
+                code = bytes([OPCODES[op]['rel'], offset & 0xFF])
+            elif arg.startswith('#'):
+                code = bytes([OPCODES[op]['imm'], value(arg[1:], labels, final) & 0xFF])
+            elif arg.startswith('(') and arg.upper().endswith(',X)'):
+                code = bytes([OPCODES[op]['izx'], value(arg[1:-3], labels, final)])
+            elif arg.startswith('(') and arg.upper().endswith('),Y'):
+                code = bytes([OPCODES[op]['izy'], value(arg[1:-3], labels, final)])
+            elif arg.startswith('('):
+                target = value(arg[1:-1], labels, final)
+                code = bytes([OPCODES[op]['ind'], target & 0xFF, target >> 8])
+            else:
+                index = ''
+                if arg.upper().endswith(',X') or arg.upper().endswith(',Y'):
+                    index = arg[-1].lower()
+                    arg = arg[:-2]
+
+                forced = arg.startswith('!')
+                if forced:
+                    arg = arg[1:]
+
+                target = value(arg, labels, final)
+                zeroPage = not forced and target < 0x100 and 'zp' + index in OPCODES[op]
+                mode = ('zp' if zeroPage else 'ab') + (index if index else ('' if zeroPage else 's'))
+
+                if zeroPage:
+                    code = bytes([OPCODES[op][mode], target])
+                else:
+                    code = bytes([OPCODES[op][mode], target & 0xFF, target >> 8])
+
+            out += code
+            pc += len(code)
+
+        return out
+
+    labels = {}
+    encode(False, labels)
+    return encode(True, labels), labels
+
+#------------------#
+# ROM Images       #
+#------------------#
+
+def ines(prg, chr, mapper):
+    """Wraps PRG and CHR ROM in an iNES header, with vertical mirroring."""
+    header = b'NES\x1a' + bytes([len(prg) // 0x4000, len(chr) // 0x2000, ((mapper & 0x0F) << 4) | 1, mapper & 0xF0]) + bytes(8)
+    return header + bytes(prg) + bytes(chr)
+
+def build(source, mapper):
+    """Builds 32KB of PRG ROM with the program in its last bank, which MMC3
+    fixes at $E000, and 8KB of pseudo-random CHR ROM to draw with."""
+    prg = bytearray(0x8000)
+
+    if mapper == 4:
+        code, labels = assemble(source.replace('.ORG $C000', ''), 0xE000)
+        assert len(code) <= 0x2000 - 6
+    else:
+        code, labels = assemble(source, 0xC000)
+        assert len(code) <= 0x4000 - 6
+
+    start = len(prg) - (0x10000 - (0xE000 if mapper == 4 else 0xC000))
+    prg[start:start + len(code)] = code
+    prg[-6:] = struct.pack('<HHH', labels['nmi'], labels['reset'], labels['irq'])
+
+    rng = random.Random(7)
+    chr = bytearray(rng.randrange(256) for _ in range(0x2000))
+    return ines(prg, chr, mapper)
+
+if __name__ == '__main__':
+    here = os.path.dirname(os.path.abspath(__file__))
+    source = open(os.path.join(here, 'test.s')).read()
+
+    for name, mapper in (('nrom.nes', 0), ('mmc3.nes', 4)):
+        with open(os.path.join(here, name), 'wb') as rom:
+            rom.write(build(source, mapper))
@@ -0,0 +1,211 @@
+.ORG $C000
+reset:
+  SEI
+  CLD
+  LDX #$FF
+  TXS
+  LDA #0
+  STA $2000
+  STA $2001
+vw1:
+  BIT $2002
+  BPL vw1
+  LDA #0
+  TAX
+clr:
+  STA $00,X
+  STA !$0200,X
+  STA !$0300,X
+  INX
+  BNE clr
+vw2:
+  BIT $2002
+  BPL vw2
+  ; palette
+  LDA #$3F
+  STA $2006
+  LDA #$00
+  STA $2006
+  LDX #0
+pal:
+  TXA
+  ADC #$07
+  AND #$3F
+  STA $2007
+  INX
+  CPX #32
+  BNE pal
+  ; nametables 0 and 1 (4 x 256 bytes each)
+  LDA #$20
+  STA $2006
+  LDA #$00
+  STA $2006
+  LDY #8
+  LDX #0
+nt:
+  TXA
+  EOR $10
+  STA $2007
+  INX
+  BNE nt
+  INC $10
+  DEY
+  BNE nt
+  ; OAM buffer: 64 sprites
+  LDX #0
+oam:
+  TXA
+  ASL A
+  ADC #20
+  STA !$0200,X  ; y
+  TXA
+  STA !$0201,X  ; tile
+  AND #$E3
+  STA !$0202,X  ; attrib
+  TXA
+  ASL A
+  STA !$0203,X  ; x
+  INX
+  INX
+  INX
+  INX
+  BNE oam
+  LDA #30
+  STA !$0200
+  LDA #40
+  STA !$0203
+  ; mapper 4 irq setup (harmless on other mappers' ROM area? writes go to ROM on m0)
+  LDA $F0
+  BEQ noirq
+noirq:
+  ; copy the routine run from RAM, from ROM
+  LDX #0
+ldr:
+  LDA ramcode,X
+  STA !$0500,X
+  INX
+  CPX #32
+  BNE ldr
+  LDA #$88
+  STA $2000
+  STA $20
+  LDA #$1E
+  STA $2001
+  CLI
+main:
+  LDA $11
+wait:
+  CMP $11
+  BEQ wait
+  ; copy loop
+  LDX #0
+copy:
+  LDA !$0200,X
+  STA !$0400,X
+  INX
+  BNE copy
+  ; countdown
+  LDX #200
+cd:
+  DEX
+  BNE cd
+  LDY #100
+cd2:
+  DEY
+  BNE cd2
+  LDA #$F0
+  STA $12
+inc1:
+  INC $12
+  BNE inc1
+  ; sprite zero split
+s0a:
+  BIT $2002
+  BVS s0a
+s0b:
+  BIT $2002
+  BVC s0b
+  LDA $11
+  STA $2005
+  LDA #0
+  STA $2005
+  ; read some VRAM
+  LDA #$20
+  STA $2006
+  LDA #$05
+  STA $2006
+  LDA $2007
+  LDA $2007
+  STA $13
+  ; run code from RAM, after rewriting its operands both ways
+  LDA $11
+  LDX #1
+  STA !$0500,X
+  JSR $0500
+  JMP main
+nmi:
+  PHA
+  TXA
+  PHA
+  TYA
+  PHA
+  LDA #$02
+  STA $4014
+  LDA $2002
+  LDA $11
+  STA $2005
+  ASL A
+  STA $2005
+  LDA $11
+  AND #$01
+  ORA #$88
+  STA $2000
+  INC $11
+  ; move sprites
+  LDX #4
+mv:
+  INC !$0203,X
+  INX
+  INX
+  INX
+  INX
+  BNE mv
+  ; poke mapper4 irq regs ($C000 latch, $C001 reload, $E001 enable)
+  LDA #20
+  STA $C000
+  STA $C001
+  STA $E001
+  PLA
+  TAY
+  PLA
+  TAX
+  PLA
+  RTI
+irq:
+  PHA
+  STA $E000
+  STA $E001
+  LDA $11
+  AND #$07
+  STA $2005
+  STA $2005
+  PLA
+  RTI
+
+; copied to $0500, so only relative branches
+ramcode:
+  LDA #$00
+  CLC
+  ADC #$03
+  STA !$0501
+  STA $14
+  LDX #8
+rl:
+  ROL $15
+  ROR A
+  SBC $14
+  EOR #$5A
+  DEX
+  BNE rl
+  STA $16
+  RTS
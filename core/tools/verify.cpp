@@ -0,0 +1,322 @@
+//------------------------------------------------------------------------------//
+//                                                                              //
+//  OCR-NES - An NES Emulator written for the OCR A-Level                       //
+//  Computer Science Programming Project.                                       //
+//                                                                              //
+//  Copyright (C) 2021 - 2022 Conaer Macpherson                                 //
+//                                                                              //
+//------------------------------------------------------------------------------//
+
+/**
+ * @file verify.cpp
+ * @author Conaer Macpherson (Candidate No. 6189)
+ * @brief Checks that the emulator's interchangeable modes give identical results.
+ * @version 0.1
+ * @date 2022-03-22
+ *
+ * @copyright Copyright (c) 2021 - 2022
+ *
+ */
+
+// Project Headers.
+#include <nes.h>
+
+// Language Headers.
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+//------------------------------------------------------------------------------//
+// Runs a ROM on systems which differ only in modes that should not change the  //
+// results, i.e. their timing, the CPU's dispatch method or core, or the JIT,   //
+// comparing their state as they go, and reports the first difference. Exits    //
+// with 1 if there is one, so it can be run over a corpus of ROMs, which CTest  //
+// does with the ROMs in tests/roms.                                            //
+//------------------------------------------------------------------------------//
+
+/**
+ * @brief A combination of the modes which should not change the results.
+ */
+struct Configuration
+{
+	CPU::Dispatch dispatch;
+	Bus::Timing timing;
+	Bus::CPUCore core;
+};
+
+// The simplest configuration, which every other is compared against: the SWITCH
+// interpreter, clocked in lock-step with the PPU, making all of an instruction's
+// accesses on its first cycle.
+static constexpr Configuration REFERENCE = { CPU::Dispatch::SWITCH, Bus::Timing::LOCKSTEP, Bus::CPUCore::FAST };
+
+// Every other configuration of the fast core, compared frame by frame.
+static constexpr Configuration CONFIGURATIONS[] = {
+	{ CPU::Dispatch::TABLE, Bus::Timing::LOCKSTEP, Bus::CPUCore::FAST },
+	{ CPU::Dispatch::CACHED, Bus::Timing::LOCKSTEP, Bus::CPUCore::FAST },
+	{ CPU::Dispatch::JIT, Bus::Timing::LOCKSTEP, Bus::CPUCore::FAST },
+	{ CPU::Dispatch::TABLE, Bus::Timing::CATCH_UP, Bus::CPUCore::FAST },
+	{ CPU::Dispatch::SWITCH, Bus::Timing::CATCH_UP, Bus::CPUCore::FAST },
+	{ CPU::Dispatch::CACHED, Bus::Timing::CATCH_UP, Bus::CPUCore::FAST },
+	{ CPU::Dispatch::JIT, Bus::Timing::CATCH_UP, Bus::CPUCore::FAST },
+};
+
+// The configurations compared with the CPU running alone. The cycle-stepped core
+// deliberately lets the PPU see its accesses on later cycles than the reference,
+// so it can only be compared frame by frame against itself, and with the PPU
+// stopped it must match the reference exactly. It decodes each instruction
+// itself, whatever the dispatch method.
+static constexpr Configuration CPU_CONFIGURATIONS[] = {
+	{ CPU::Dispatch::JIT, Bus::Timing::LOCKSTEP, Bus::CPUCore::FAST },
+	{ CPU::Dispatch::SWITCH, Bus::Timing::CATCH_UP, Bus::CPUCore::CYCLE_STEPPED },
+};
+
+/**
+ * @brief Creates a system running a ROM, which renders to nothing.
+ *
+ * @param path The path to the ROM.
+ * @param configuration The modes to run it with.
+ * @return std::unique_ptr<OCRNES> The system, or nullptr if the ROM couldn't be loaded.
+ */
+static std::unique_ptr<OCRNES> createSystem(std::string path, const Configuration& configuration)
+{
+	std::unique_ptr<OCRNES> nes = std::make_unique<OCRNES>();
+	nes->setRenderer(std::make_shared<Drawable>());
+
+	if (!nes->loadROM(path))
+		return nullptr;
+
+	nes->bus.cpu.dispatch = configuration.dispatch;
+	nes->bus.timing = configuration.timing;
+	nes->bus.cpuCore = configuration.core;
+	return nes;
+}
+
+/**
+ * @brief Compares the state of two systems which should be identical.
+ *
+ * @param a The first system.
+ * @param b The second system.
+ * @return const char* What differs, or nullptr if nothing.
+ */
+static const char *compareSystems(OCRNES& a, OCRNES& b)
+{
+	CPU& x = a.bus.cpu;
+	CPU& y = b.bus.cpu;
+
+	if (x.a != y.a || x.x != y.x || x.y != y.y || x.sp != y.sp || x.pc != y.pc || x.getStatus() != y.getStatus())
+		return "CPU registers";
+	if (std::memcmp(a.bus.cpuRAM, b.bus.cpuRAM, sizeof(a.bus.cpuRAM)) != 0)
+		return "RAM";
+	if (std::memcmp(a.bus.ppu.frameIndices, b.bus.ppu.frameIndices, sizeof(a.bus.ppu.frameIndices)) != 0)
+		return "framebuffer";
+
+	return nullptr;
+}
+
+/**
+ * @brief Gets the name of a dispatch method.
+ */
+static const char *dispatchName(CPU::Dispatch dispatch)
+{
+	switch (dispatch)
+	{
+	case CPU::Dispatch::TABLE: return "TABLE";
+	case CPU::Dispatch::SWITCH: return "SWITCH";
+	case CPU::Dispatch::CACHED: return "CACHED";
+	case CPU::Dispatch::JIT: return "JIT";
+	}
+
+	return "?";
+}
+
+/**
+ * @brief Gets the name of a configuration, e.g. "JIT, catch-up, fast core".
+ */
+static std::string configurationName(const Configuration& configuration)
+{
+	std::string name = dispatchName(configuration.dispatch);
+	name += configuration.timing == Bus::Timing::LOCKSTEP ? ", lock-step" : ", catch-up";
+	name += configuration.core == Bus::CPUCore::FAST ? ", fast core" : ", cycle-stepped core";
+	return name;
+}
+
+//--------------------------//
+// Reference Comparison		//
+//--------------------------//
+
+/**
+ * @brief Runs a ROM with the reference configuration and every other side by
+ * side, comparing the registers, RAM and framebuffer of each against the
+ * reference after every frame. A configuration which differs is reported and
+ * no longer run, while the rest carry on.
+ *
+ * @param path The path to the ROM.
+ * @param frames The number of frames to run.
+ * @return true If every frame of every configuration matched.
+ */
+static bool verifyConfigurations(const std::string& path, u32 frames)
+{
+	constexpr size_t count = sizeof(CONFIGURATIONS) / sizeof(CONFIGURATIONS[0]);
+
+	std::unique_ptr<OCRNES> reference = createSystem(path, REFERENCE);
+	std::unique_ptr<OCRNES> systems[count];
+	bool matched[count];
+
+	for (size_t i = 0; i < count; i++)
+	{
+		systems[i] = createSystem(path, CONFIGURATIONS[i]);
+		matched[i] = true;
+	}
+
+	if (reference == nullptr || systems[0] == nullptr)
+	{
+		std::printf("%s: could not be loaded\n", path.c_str());
+		return false;
+	}
+
+	if (!systems[0]->bus.cpu.jitEnabled())
+		std::printf("%s: the JIT isn't built or can't be used, so JIT runs as CACHED\n", path.c_str());
+
+	for (u32 frame = 0; frame < frames; frame++)
+	{
+		reference->bus.runFrame();
+		reference->bus.ppu.frameComplete = false;
+
+		for (size_t i = 0; i < count; i++)
+		{
+			if (!matched[i])
+				continue;
+
+			systems[i]->bus.runFrame();
+			systems[i]->bus.ppu.frameComplete = false;
+
+			if (const char *difference = compareSystems(*reference, *systems[i]))
+			{
+				std::printf("%s: %s: %s differ from the reference after frame %u\n",
+					path.c_str(), configurationName(CONFIGURATIONS[i]).c_str(), difference, frame);
+				matched[i] = false;
+			}
+		}
+	}
+
+	bool all = true;
+	for (size_t i = 0; i < count; i++)
+	{
+		if (matched[i])
+			std::printf("%s: %s: %u frames match the reference\n", path.c_str(), configurationName(CONFIGURATIONS[i]).c_str(), frames);
+		all &= matched[i];
+	}
+
+	return all;
+}
+
+//------------------//
+// CPU Comparison	//
+//------------------//
+
+/**
+ * @brief Runs a ROM's CPU alone with the reference configuration and another
+ * side by side, over the same chunks of pseudo-random length, raising the same
+ * interrupts between some of them. The cycles used, registers and RAM are
+ * compared after every chunk. With the PPU stopped, every access sees the same
+ * state whichever cycle it is made on, so this also checks the cycle-stepped
+ * core, which only differs from the reference in when the PPU sees its accesses.
+ *
+ * @param path The path to the ROM.
+ * @param chunks The number of chunks to run.
+ * @param configuration The configuration to compare, which must differ only in
+ * its dispatch method or core.
+ * @return true If every chunk matched.
+ */
+static bool verifyCPU(const std::string& path, u32 chunks, const Configuration& configuration)
+{
+	std::unique_ptr<OCRNES> system = createSystem(path, configuration);
+	std::unique_ptr<OCRNES> reference = createSystem(path, REFERENCE);
+	if (system == nullptr || reference == nullptr)
+	{
+		std::printf("%s: could not be loaded\n", path.c_str());
+		return false;
+	}
+
+	CPU& x = system->bus.cpu;
+	CPU& y = reference->bus.cpu;
+	std::string name = configurationName(configuration);
+
+	if (configuration.dispatch == CPU::Dispatch::JIT && !x.jitEnabled())
+		std::printf("%s: the JIT isn't built or can't be used, so JIT runs as CACHED\n", path.c_str());
+
+	// The same sequence of chunk lengths every run.
+	u32 seed = 12345;
+
+	for (u32 chunk = 0; chunk < chunks; chunk++)
+	{
+		seed = seed * 1103515245 + 12345;
+		u32 budget = 1 + (seed >> 16) % 3000;
+
+		u32 used = configuration.core == Bus::CPUCore::CYCLE_STEPPED
+			? CPU::CycleSteppedCore::run(x, budget) : CPU::FastCore::run(x, budget);
+		u32 usedReference = CPU::FastCore::run(y, budget);
+
+		if (chunk % 37 == 0)
+		{
+			x.nmi();
+			y.nmi();
+		}
+		if (chunk % 53 == 0)
+		{
+			x.irq();
+			y.irq();
+		}
+
+		const char *difference = compareSystems(*system, *reference);
+		if (difference == nullptr && (used != usedReference || x.totalCycles != y.totalCycles))
+			difference = "cycle counts";
+
+		if (difference != nullptr)
+		{
+			std::printf("%s: CPU with %s: %s differ from the reference after chunk %u, PC $%04X vs $%04X\n",
+				path.c_str(), name.c_str(), difference, chunk, x.pc, y.pc);
+			return false;
+		}
+	}
+
+	std::printf("%s: CPU with %s: %u chunks, %llu cycles match the reference\n",
+		path.c_str(), name.c_str(), chunks, (unsigned long long)x.totalCycles);
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		std::printf("Usage: ocrnes-verify <rom> [count] [--cpu]\n");
+		std::printf("Compares every configuration of timing and dispatch method against the reference\n");
+		std::printf("(SWITCH dispatch, lock-step timing and the fast core), for 600 frames by default.\n");
+		std::printf("With --cpu, instead runs the CPU alone, comparing the JIT and the cycle-stepped core\n");
+		std::printf("against the reference, for 100000 chunks by default.\n");
+		return 2;
+	}
+
+	std::string path = argv[1];
+	bool compareCPU = false;
+	u32 count = 0;
+
+	for (int i = 2; i < argc; i++)
+	{
+		if (std::string(argv[i]) == "--cpu")
+			compareCPU = true;
+		else
+			count = std::strtoul(argv[i], nullptr, 10);
+	}
+
+	if (!compareCPU)
+		return verifyConfigurations(path, count > 0 ? count : 600) ? 0 : 1;
+
+	bool matched = true;
+	for (const Configuration& configuration : CPU_CONFIGURATIONS)
+		matched &= verifyCPU(path, count > 0 ? count : 100000, configuration);
+
+	return matched ? 0 : 1;
+}
@@ -18,6 +18,20 @@ void App::Start(int argc, char** argv)
         exit(1);
     }
 
+    // Optionally count which pairs of instructions the game executes most,
+    // printed on exit to find candidates for fusing, and optionally run the
+    // CPU cycle by cycle for games which depend on mid-instruction timing.
+    bool profilePairs = false;
+    bool cycleStepped = false;
+    for (int i = 2; i < argc; i++)
+    {
+        std::string option(argv[i]);
+        if (option == "--profile-pairs")
+            profilePairs = true;
+        else if (option == "--cycle-stepped")
+            cycleStepped = true;
+    }
+
     emulator.init(&input);
 
     // Load the ROM ready to begin emulation.
@@ -27,6 +41,12 @@ void App::Start(int argc, char** argv)
         exit(1);
     }
 
+    if (profilePairs)
+        emulator.emu.bus.cpu.setPairProfiling(true);
+
+    if (cycleStepped)
+        emulator.emu.bus.cpuCore = Bus::CPUCore::CYCLE_STEPPED;
+
     GUI gui(this);
 
     // Create the SFML RenderWindow and resize to be nice and big.
@@ -117,6 +137,22 @@ void App::Start(int argc, char** argv)
     }
 
     ImGui::SFML::Shutdown();
+
+    // Keep the last instructions executed, if the trace is built in.
+    if constexpr (decltype(emulator.emu.bus.cpu.trace)::ENABLED)
+    {
+        std::ofstream trace(path + ".trace");
+        emulator.emu.bus.cpu.dumpTrace(trace);
+    }
+
+    if (profilePairs)
+    {
+        printf("Hottest instruction pairs:\n");
+        for (const CPU::PairCount& pair : emulator.emu.bus.cpu.getHottestPairs(20))
+            printf("%02X %02X  %-8s -> %-8s %llu\n", pair.first, pair.second,
+                CPU::getOpcodeName(pair.first).c_str(), CPU::getOpcodeName(pair.second).c_str(),
+                (unsigned long long)pair.count);
+    }
 }
 
 void App::saveState(u8 slot)
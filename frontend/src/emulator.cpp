@@ -58,11 +58,7 @@ void Emulator::runFrame(bool render)
     handleControllerInput(&(emu.bus.controller[0]));
 
     emu.bus.ppu.renderThisFrame = render;
-    do
-    {
-        emu.bus.clockCycle();
-    }
-    while(!(emu.bus.ppu.frameComplete));
+    emu.bus.runFrame();
 
     emu.bus.ppu.frameComplete = false;
 }
@@ -24,6 +24,8 @@
 
 #include <drawable.h>
 
+#include <cstring>
+
 class SFMLRenderer : public Drawable
 {
 public:
@@ -33,6 +35,9 @@ public:
     // The framebuffer.
     sf::Uint8 screen[240][256][4];
 
+    // Whether the framebuffer has changed since the texture was updated.
+    bool screenChanged = true;
+
     SFMLRenderer()
     {
         // Create the screen texture.
@@ -51,18 +56,36 @@ public:
         sprite.setTexture(tex);
     }
 
-    void setPixel(int x, int y, RGBAColor color)
+    void submitFrame(const RGBAColor *frame, const bool *dirtyRows) override
+    {
+        // RGBAColor is laid out as the framebuffer's pixels are, so rows copy directly.
+        for (int y = 0; y < HEIGHT; y++)
+        {
+            if (dirtyRows == nullptr || dirtyRows[y])
+            {
+                std::memcpy(screen[y], &frame[y * WIDTH], sizeof(screen[y]));
+                screenChanged = true;
+            }
+        }
+    }
+
+    void setPixel(int x, int y, RGBAColor color) override
     {
         screen[y][x][0] = color.r;
         screen[y][x][1] = color.g;
         screen[y][x][2] = color.b;
         screen[y][x][3] = color.a;
+        screenChanged = true;
     }
 
     void draw(sf::RenderWindow& window)
     {
-        // Update the screen sprite's texture with the framebuffer.
-        tex.update((sf::Uint8*)screen);
+        // Update the screen sprite's texture with the framebuffer, if it has changed.
+        if (screenChanged)
+        {
+            tex.update((sf::Uint8*)screen);
+            screenChanged = false;
+        }
 
         // Clear the window with black.
         window.clear(sf::Color(0, 0, 0, 255));